@@ -83,14 +83,17 @@ void Application::run()
         if (!_dsplTask.init(_connectionManager, literals::tsk_dspl, tskIDLE_PRIORITY + 1ul, 2*4096))
             break;
 
-        if (!_mqttTask.init(_connectionManager, literals::tsk_mqtt, tskIDLE_PRIORITY + 1ul, 4096))
+        if (!_ingestTask.init(literals::tsk_ingest, tskIDLE_PRIORITY + 1ul, 4096))
+            break;
+
+        if (!_mqttTask.init(_connectionManager, literals::tsk_mqtt, tskIDLE_PRIORITY + 1ul, 2 * 4096))
             break;
 
         if (!_timeTask.init(_connectionManager, literals::tsk_time, tskIDLE_PRIORITY + 1ul, 4096))
             break;
 
 
-        waitForAllTasks({TaskBit::WiFi, TaskBit::Web, TaskBit::Reset, TaskBit::Display, TaskBit::Mqtt, TaskBit::Time});
+        waitForAllTasks({TaskBit::WiFi, TaskBit::Web, TaskBit::Reset, TaskBit::Display, TaskBit::Mqtt, TaskBit::Time, TaskBit::Ingest});
 
         ESP_LOGI(TAG, "All tasks initialized. Proceeding...");
 
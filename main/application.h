@@ -19,6 +19,7 @@
 #include "dspl_task.h"
 #include "mqtt_task.h"
 #include "time_task.h"
+#include "ingest_task.h"
 #include "connection_manager.h"
 #include "freertos/event_groups.h"
 
@@ -37,7 +38,8 @@ public:
     Reset = (1 << 2), // Bit 2  ResetTask
     Display = (1 << 3), // Bit 3 DsplTask
     Mqtt = (1 << 4), // Bit 4 MqttTask
-    Time = (1 << 5) // Bit 5 TimeTask
+    Time = (1 << 5), // Bit 5 TimeTask
+    Ingest = (1 << 6) // Bit 6 IngestTask
 };
    
     /**
@@ -69,6 +71,7 @@ public:
     ResetTask *getResetTask() {return  &_resetTask; }
     DisplayTask *getDisplayTask() {return  &_dsplTask; }
     MqttTask *getMqttTask() {return  &_mqttTask; }
+    IngestTask *getIngestTask() {return  &_ingestTask; }
     
     /**
      * Singleton
@@ -94,6 +97,7 @@ private:
     DisplayTask _dsplTask;         ///< display task
     MqttTask    _mqttTask;         ///< mqtt task
     TimeTask    _timeTask;         ///< time sync task
+    IngestTask  _ingestTask;       ///< mqtt payload parsing
     EventGroupHandle_t _taskEventGroup{nullptr};
 
 
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <iostream>
 #include <freertos/FreeRTOS.h>
@@ -14,6 +15,7 @@
 #include <freertos/event_groups.h>
 #include <esp_log.h>
 #include <esp_event.h>
+#include <esp_timer.h>
 #include <esp_eth.h>
 #include <esp_netif.h>
 #include <mqtt_client.h>
@@ -33,6 +35,7 @@ public:
         {
             // Clear all bits to ensure a known initial state
             xEventGroupClearBits(event_group, WIFI_CONNECTED_BIT | MQTT_CONNECTED_BIT);
+            xEventGroupSetBits(event_group, WIFI_DISCONNECTED_BIT | MQTT_DISCONNECTED_BIT);
         }
     }
 
@@ -49,7 +52,10 @@ public:
     {
         if (event_group)
         { // Check if event_group is not NULL
+            _connectedAt = esp_timer_get_time();
+            xEventGroupClearBits(event_group, WIFI_DISCONNECTED_BIT);
             xEventGroupSetBits(event_group, WIFI_CONNECTED_BIT);
+            notifyListener();
         }
         else
         {
@@ -63,6 +69,8 @@ public:
         if (event_group)
         {
             xEventGroupClearBits(event_group, WIFI_CONNECTED_BIT);
+            xEventGroupSetBits(event_group, WIFI_DISCONNECTED_BIT);
+            notifyListener();
         }
         else
         {
@@ -90,7 +98,9 @@ public:
     {
         if (event_group)
         {
+            xEventGroupClearBits(event_group, MQTT_DISCONNECTED_BIT);
             xEventGroupSetBits(event_group, MQTT_CONNECTED_BIT);
+            notifyListener();
         }
         else
         {
@@ -104,6 +114,8 @@ public:
         if (event_group)
         {
             xEventGroupClearBits(event_group, MQTT_CONNECTED_BIT);
+            xEventGroupSetBits(event_group, MQTT_DISCONNECTED_BIT);
+            notifyListener();
         }
         else
         {
@@ -132,6 +144,7 @@ public:
         if (event_group)
         {
             xEventGroupSetBits(event_group, AP_BIT);
+            notifyListener();
         }
         else
         {
@@ -145,6 +158,7 @@ public:
         if (event_group)
         {
             xEventGroupClearBits(event_group, AP_BIT);
+            notifyListener();
         }
         else
         {
@@ -173,6 +187,7 @@ public:
         if (event_group)
         {
             xEventGroupSetBits(event_group, TIME_BIT);
+            notifyListener();
         }
         else
         {
@@ -186,6 +201,7 @@ public:
         if (event_group)
         {
             xEventGroupClearBits(event_group, TIME_BIT);
+            notifyListener();
         }
         else
         {
@@ -208,6 +224,46 @@ public:
         }
     }
 
+    // Blocks until any of the bits is set (bits are not cleared), returns the current bits
+    EventBits_t waitAny(EventBits_t bits, TickType_t timeout) const
+    {
+        if (event_group)
+        {
+            return xEventGroupWaitBits(event_group, bits, pdFALSE, pdFALSE, timeout);
+        }
+        else
+        {
+            ESP_LOGE(LOG_TAG, "Event group is NULL in waitAny");
+            vTaskDelay(timeout == portMAX_DELAY ? pdMS_TO_TICKS(1000) : timeout);
+            return 0;
+        }
+    }
+
+    // Waits for Wifi connection
+    bool waitConnected(TickType_t timeout) const
+    {
+        return waitAny(WIFI_CONNECTED_BIT, timeout) & WIFI_CONNECTED_BIT;
+    }
+
+    // Waits for Wifi disconnection
+    bool waitDisconnected(TickType_t timeout) const
+    {
+        return waitAny(WIFI_DISCONNECTED_BIT, timeout) & WIFI_DISCONNECTED_BIT;
+    }
+
+    // Time of the last setConnected (esp_timer, us)
+    int64_t connectedAt() const
+    {
+        return _connectedAt;
+    }
+
+    // The task is notified (eSetBits) with the bits on every state change
+    void setListener(TaskHandle_t task, uint32_t bits)
+    {
+        _listenerBits = bits;
+        _listener = task;
+    }
+
     // Returns the event group handle
     EventGroupHandle_t getEventGroup() const
     {
@@ -222,12 +278,29 @@ public:
         }
     }
 
-private:
-    static constexpr const char *LOG_TAG = "ConnectionManager";
-
-    EventGroupHandle_t event_group;
+    // state bits - the disconnected ones are complements, so that both
+    // edges can be waited for with waitAny
     static const int WIFI_CONNECTED_BIT = BIT0;
     static const int MQTT_CONNECTED_BIT = BIT1;
     static const int AP_BIT = BIT2;
     static const int TIME_BIT = BIT3;
+    static const int WIFI_DISCONNECTED_BIT = BIT4;
+    static const int MQTT_DISCONNECTED_BIT = BIT5;
+
+private:
+    static constexpr const char *LOG_TAG = "ConnectionManager";
+
+    void notifyListener()
+    {
+        TaskHandle_t listener = _listener;
+        if (listener)
+        {
+            xTaskNotify(listener, _listenerBits, eSetBits);
+        }
+    }
+
+    EventGroupHandle_t event_group;
+    std::atomic<int64_t> _connectedAt{0};
+    std::atomic<TaskHandle_t> _listener{nullptr};
+    std::atomic<uint32_t> _listenerBits{0};
 };
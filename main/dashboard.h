@@ -5,6 +5,9 @@
 /// @author Petr Vanek
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <functional>
 #include <string>
 #include <string_view>
@@ -12,6 +15,7 @@
 #include <sstream>
 #include <numeric>
 #include "esp_log.h"
+#include "sdkconfig.h"
 #include "display_driver.h"
 #include "icons8_solar_panel_48.h"
 #include "icons8_car_battery_48.h"
@@ -33,6 +37,7 @@ private:
     lv_obj_t *_settingsExitBtn{nullptr};  // Exit button
     lv_obj_t *_settingsApBtn{nullptr};    // AP settings button
     lv_obj_t *_settingsTextArea{nullptr}; // Text area
+    lv_obj_t *_statsLabel{nullptr};       // Display statistics
 
     lv_obj_t *_screen{nullptr};
     lv_obj_t *_solarPanelFrame{nullptr};
@@ -69,9 +74,18 @@ private:
     lv_obj_t *_totalCons{nullptr};
     lv_obj_t *_totalSol{nullptr};
 
+    uint32_t _staleTiles{0}; // bit per Tile, greyed out
+
     lv_chart_series_t *_chartSeries{nullptr};
     int _currentDataSetIndex{0};
     int _lastDataSetIndex{0};
+    int _rangeMin{0};
+    int _rangeMax{-1}; // -1 forces the next range update
+
+    static constexpr int ChartHeadroom = 4; // range = max + max / ChartHeadroom
+    static constexpr int ChartMinRange = 100;
+    static constexpr long ChartValueMin = -LV_CHART_POINT_NONE;
+    static constexpr long ChartValueMax = LV_CHART_POINT_NONE - 1;
 
     enum EnergyBarMode
     {
@@ -94,14 +108,45 @@ private:
     {
         const char *description;
         lv_color_t color;
-        int data[24];
+        lv_coord_t data[24]; // bound to the chart series as its y array
+        int min;
+        int max;
     };
 
     ChartDataSet _dataSets[2] = {
-        {"Photovoltaic Yield", lv_color_hex(0xFF4500), {LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE}},
-        {"Energy Consumption", lv_color_hex(0x007BFF), {LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE}}};
+        {"Photovoltaic Yield", lv_color_hex(0xFF4500), {LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE}, 0, 0},
+        {"Energy Consumption", lv_color_hex(0x007BFF), {LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE}, 0, 0}};
 
 public:
+    // tiles of the main screen
+    enum class Tile
+    {
+        Solar,
+        Battery,
+        Grid,
+        Consumption,
+        Overview,
+        EnergyBar
+    };
+
+    /// @brief Greys out a tile whose values are no longer updated
+    void setTileStale(Tile tile, bool stale)
+    {
+        const uint32_t bit = 1u << static_cast<int>(tile);
+        if (((_staleTiles & bit) != 0) == stale)
+        {
+            return;
+        }
+        _staleTiles = stale ? (_staleTiles | bit) : (_staleTiles & ~bit);
+
+        lv_obj_t *frames[] = {_solarPanelFrame, _batteryFrame, _gridFrame, _consumptionFrame, _overviewFrame, _energyBarFrame};
+        lv_obj_t *frame = frames[static_cast<int>(tile)];
+        if (frame)
+        {
+            lv_obj_set_style_opa(frame, stale ? LV_OPA_40 : LV_OPA_COVER, 0);
+        }
+    }
+
     void disableSettingsApButton()
     {
         if (_settingsApBtn)
@@ -171,7 +216,7 @@ public:
         }
 
         lv_img_set_src(_messageIcon, message.icon);
-        lv_label_set_text(_messageLabel, message.text);
+        setText(_messageLabel, message.text);
     }
 
     void registerApSettingCallback(const std::function<void()> &callback)
@@ -251,6 +296,21 @@ public:
 
         // Set the text area to read-only
         lv_obj_add_flag(_settingsTextArea, LV_OBJ_FLAG_CLICKABLE); // Disable interaction
+
+#if CONFIG_PVVIEW_DISPLAY_STATS
+        // Render and flush statistics
+        _statsLabel = addLabel(_settingsScreen, "", LV_ALIGN_BOTTOM_MID, 0, -20, &lv_font_montserrat_12);
+#endif
+    }
+
+    bool isSettingsScreenActive() const
+    {
+        return _settingsScreen && lv_scr_act() == _settingsScreen;
+    }
+
+    void updateStats(const char *text)
+    {
+        setText(_statsLabel, text);
     }
 
     void showMainScreen()
@@ -393,15 +453,15 @@ public:
     {
         if (temp < 15)
         {
-            lv_obj_set_style_text_color(label, lv_color_hex(0x0000FF), 0); // Blue for cold
+            setTextColor(label, lv_color_hex(0x0000FF)); // Blue for cold
         }
         else if (temp <= 30)
         {
-            lv_obj_set_style_text_color(label, lv_color_hex(0x000000), 0); // Black for normal
+            setTextColor(label, lv_color_hex(0x000000)); // Black for normal
         }
         else
         {
-            lv_obj_set_style_text_color(label, lv_color_hex(0xFF0000), 0); // Orange for hot
+            setTextColor(label, lv_color_hex(0xFF0000)); // Orange for hot
         }
     }
 
@@ -425,18 +485,16 @@ public:
 
     void hdoUpdate(int hdo)
     {
-        ESP_LOGI(TAG, "HDO: %d", hdo);
+        ESP_LOGD(TAG, "HDO: %d", hdo);
         if (hdo)
         {
-            lv_led_set_color(_hdoLed, lv_color_hex(0x00FF00)); // Green for online
-            lv_led_on(_hdoLed);                                // Turn the LED on
-            lv_obj_clear_flag(_hdoLed, LV_OBJ_FLAG_HIDDEN);
+            setLed(_hdoLed, lv_color_hex(0x00FF00), true); // Green for online
+            setHidden(_hdoLed, false);
         }
         else
         {
-            lv_led_set_color(_hdoLed, lv_color_hex(0x00FF00)); 
-            lv_led_off(_hdoLed);                                // Turn the LED OFF
-            lv_obj_add_flag(_hdoLed, LV_OBJ_FLAG_HIDDEN);
+            setLed(_hdoLed, lv_color_hex(0x00FF00), false); // Turn the LED OFF
+            setHidden(_hdoLed, true);
         }
     }
 
@@ -445,50 +503,50 @@ public:
 
         int totalPower = string1Power + string2Power;
 
-        lv_label_set_text(_solarPanelTotalPowerLabel, Utils::formatPower(totalPower).c_str());
+        updateLabel(_solarPanelTotalPowerLabel, totalPower);
 
-        lv_label_set_text(_solarPanelString1Label, Utils::formatPower(string1Power).c_str());
-        lv_label_set_text(_solarPanelString2Label, Utils::formatPower(string2Power).c_str());
+        updateLabel(_solarPanelString1Label, string1Power);
+        updateLabel(_solarPanelString2Label, string2Power);
 
         if (totalPower > 100)
         {
 
-            lv_obj_set_style_border_color(_solarPanelFrame, lv_color_hex(0x00FF00), 0);
+            setBorderColor(_solarPanelFrame, lv_color_hex(0x00FF00));
         }
         else
         {
 
-            lv_obj_set_style_border_color(_solarPanelFrame, lv_color_hex(0x000000), 0);
+            setBorderColor(_solarPanelFrame, lv_color_hex(0x000000));
         }
     }
 
     void updateBattery(int percentage, int power, float temp)
     {
         char text[20];
-        sprintf(text, "%d%%", percentage);
-        lv_label_set_text(_batteryPercentageLabel, text);
+        Utils::formatPercent(text, sizeof(text), percentage);
+        setText(_batteryPercentageLabel, text);
 
-        lv_label_set_text(_batteryPowerLabel, Utils::formatPower(power).c_str());
+        updateLabel(_batteryPowerLabel, power);
 
-        sprintf(text, "%.1f °C", temp);
-        lv_label_set_text(_batteryTempLabel, text);
+        Utils::formatTemperature(text, sizeof(text), temp);
+        setText(_batteryTempLabel, text);
         updateTemperatureTextColor(_batteryTempLabel, temp);
 
         // Change the frame color based on power
         if (power == 0)
         {
             // Black for zero power
-            lv_obj_set_style_border_color(_batteryFrame, lv_color_hex(0x000000), 0);
+            setBorderColor(_batteryFrame, lv_color_hex(0x000000));
         }
         else if (power > 100)
         {
             // Dark green for positive power
-            lv_obj_set_style_border_color(_batteryFrame, lv_color_hex(0x00EE00), 0);
+            setBorderColor(_batteryFrame, lv_color_hex(0x00EE00));
         }
         else if (power < 100)
         {
             // Dark red for negative power
-            lv_obj_set_style_border_color(_batteryFrame, lv_color_hex(0xEE0000), 0);
+            setBorderColor(_batteryFrame, lv_color_hex(0xEE0000));
         }
     }
 
@@ -504,30 +562,28 @@ public:
 
         if (ongrid)
         {
-            lv_led_set_color(_gridLed, lv_color_hex(0x00FF00)); // Green for online
-            lv_led_on(_gridLed);                                // Turn the LED on
+            setLed(_gridLed, lv_color_hex(0x00FF00), true); // Green for online
         }
         else
         {
-            lv_led_set_color(_gridLed, lv_color_hex(0xFF0000)); // Red for offline
-            lv_led_on(_gridLed);                                // Turn the LED on
+            setLed(_gridLed, lv_color_hex(0xFF0000), true); // Red for offline
         }
 
         // Change the frame color based on power
         if (power > 100)
         {
             // Dark green for power greater than +500 W
-            lv_obj_set_style_border_color(_gridFrame, lv_color_hex(0x00EE00), 0);
+            setBorderColor(_gridFrame, lv_color_hex(0x00EE00));
         }
         else if (power < -100)
         {
             // Dark red for power less than -500 W
-            lv_obj_set_style_border_color(_gridFrame, lv_color_hex(0xEE0000), 0);
+            setBorderColor(_gridFrame, lv_color_hex(0xEE0000));
         }
         else
         {
             // Black for power in range -500 to +500 W
-            lv_obj_set_style_border_color(_gridFrame, lv_color_hex(0x000000), 0);
+            setBorderColor(_gridFrame, lv_color_hex(0x000000));
         }
     }
 
@@ -535,8 +591,8 @@ public:
     {
         updateLabel(_overviewPowerLabel, power);
         char tempText[20];
-        sprintf(tempText, "%.1f °C", temp);
-        lv_label_set_text(_overviewTempLabel, tempText);
+        Utils::formatTemperature(tempText, sizeof(tempText), temp);
+        setText(_overviewTempLabel, tempText);
         updateTemperatureTextColor(_overviewTempLabel, temp);
     }
 
@@ -544,13 +600,16 @@ public:
     {
         if (value < 0)
         {
-            lv_obj_set_style_bg_color(_energyBar, lv_color_hex(0xFF0000), LV_PART_INDICATOR); // Red for negative
+            setBgColor(_energyBar, lv_color_hex(0xFF0000), LV_PART_INDICATOR); // Red for negative
         }
         else
         {
-            lv_obj_set_style_bg_color(_energyBar, lv_color_hex(0x00FF00), LV_PART_INDICATOR); // Green for positive
+            setBgColor(_energyBar, lv_color_hex(0x00FF00), LV_PART_INDICATOR); // Green for positive
+        }
+        if (lv_bar_get_value(_energyBar) != abs(value))
+        {
+            lv_bar_set_value(_energyBar, abs(value), LV_ANIM_ON);
         }
-        lv_bar_set_value(_energyBar, abs(value), LV_ANIM_ON);
         updateLabel(_energyBarLabel, value);
     }
 
@@ -617,11 +676,8 @@ public:
         // Create the series and assign it to _chartSeries
         _chartSeries = lv_chart_add_series(_chart, barColor, LV_CHART_AXIS_PRIMARY_Y);
 
-        // Populate the series with initial data
-        for (int i = 0; i < 24; i++)
-        {
-            lv_chart_set_value_by_id(_chart, _chartSeries, i, _dataSets[0].data[i]);
-        }
+        // The series draws straight from the data set, LVGL keeps no copy
+        lv_chart_set_ext_y_array(_chart, _chartSeries, _dataSets[0].data);
 
         // Maximum info
         _maxLabel = lv_label_create(lv_obj_get_parent(_chart));
@@ -668,34 +724,27 @@ public:
             return;
         }
 
-        int minValue = 0;
-        int maxValue = 0;
+        const ChartDataSet &dataSet = _dataSets[_currentDataSetIndex];
 
-        for (int i = 0; i < 24; i++)
+        // the range only moves when the data leaves it or shrinks well below it,
+        // a range change redraws the whole chart
+        int rangeMin = std::min(dataSet.min, 0);
+        bool shrink = _rangeMax > ChartMinRange && dataSet.max < _rangeMax / 2;
+        if (rangeMin != _rangeMin || dataSet.max > _rangeMax || shrink)
         {
-            int value = _dataSets[_currentDataSetIndex].data[i];
-            if (value == LV_CHART_POINT_NONE)
-                continue;
-            if (value < minValue)
-                minValue = value;
-            if (value > maxValue)
-                maxValue = value;
+            _rangeMin = rangeMin;
+            _rangeMax = std::max(dataSet.max + dataSet.max / ChartHeadroom, ChartMinRange);
+            lv_chart_set_range(_chart, LV_CHART_AXIS_PRIMARY_Y, _rangeMin, _rangeMax);
         }
 
-        lv_chart_set_range(_chart, LV_CHART_AXIS_PRIMARY_Y, minValue, maxValue);
-        lv_chart_refresh(_chart);
-
         if (_maxLabel)
         {
-            std::string mx = "Max: ";
-            if (maxValue == INT16_MIN || minValue == INT16_MAX)
-                _maxLabel = 0;
-            mx += Utils::formatPower(maxValue, "W", "h");
-            lv_label_set_text(_maxLabel, mx.c_str());
+            static constexpr char prefix[] = "Max: ";
+            char mx[32];
+            std::memcpy(mx, prefix, sizeof(prefix) - 1);
+            Utils::formatPower(mx + sizeof(prefix) - 1, sizeof(mx) - (sizeof(prefix) - 1), dataSet.max, "W", "h");
+            setText(_maxLabel, mx);
         }
-
-       //ESP_LOGI(TAG, "Chart range updated: Min=%d, Max=%d", minValue, maxValue);
-       //ESP_LOGI(TAG, "Chart range index: %d\n", _currentDataSetIndex);
     }
 
     void updateChart()
@@ -707,23 +756,16 @@ public:
         else
         {
             graphDisplay(false);
-            lv_label_set_text(_chartTitleLabel, _dataSets[_currentDataSetIndex].description);
+            setText(_chartTitleLabel, _dataSets[_currentDataSetIndex].description);
             lv_chart_set_series_color(_chart, _chartSeries, _dataSets[_currentDataSetIndex].color);
-
-            for (int i = 0; i < 24; i++)
-            {
-                lv_chart_set_value_by_id(_chart, _chartSeries, i, _dataSets[_currentDataSetIndex].data[i]);
-            }
-
+            lv_chart_set_ext_y_array(_chart, _chartSeries, _dataSets[_currentDataSetIndex].data);
+            _rangeMax = -1; // force the range of the new data set
             updateChartRange();
-            //ESP_LOGI(TAG, "Dataset switched to: %s\n", _dataSets[_currentDataSetIndex].description);
         }
     }
 
     void onChartClick()
     {
-        ESP_LOGI(TAG, "onChartClick called");
-
         if (!_chart)
         {
             ESP_LOGE(TAG, "Error: _chart is null");
@@ -750,23 +792,19 @@ public:
             {
                 _dataSets[datasetIndex].data[hour] = LV_CHART_POINT_NONE;
             }
+            _dataSets[datasetIndex].min = 0;
+            _dataSets[datasetIndex].max = 0;
         }
         ESP_LOGI(TAG, "All data sets cleared\n");
 
         // Optionally update the chart if it's active
         if (_chartSeries && _chart)
         {
-            for (int i = 0; i < 24; i++)
-            {
-                lv_chart_set_value_by_id(_chart, _chartSeries, i, LV_CHART_POINT_NONE);
-            }
-
             updateChart();
-            updateChartRange();
         }
     }
 
-    void updateDataSetHour(int datasetIndex, int hour, int newValue)
+    void updateDataSetHour(int datasetIndex, int hour, float newValue)
     {
         if (datasetIndex < 0 || datasetIndex >= 2)
         {
@@ -780,20 +818,23 @@ public:
             return;
         }
 
-        _dataSets[datasetIndex].data[hour] = (newValue == 0) ? LV_CHART_POINT_NONE : newValue;
+        long rounded = std::clamp(lroundf(newValue), ChartValueMin, ChartValueMax);
+        lv_coord_t value = (rounded == 0) ? LV_CHART_POINT_NONE : static_cast<lv_coord_t>(rounded);
+        ChartDataSet &dataSet = _dataSets[datasetIndex];
+        if (dataSet.data[hour] == value)
+        {
+            return;
+        }
+
+        int previous = dataSet.data[hour];
+        dataSet.data[hour] = value;
+        updateExtremes(dataSet, previous, value);
 
         if (datasetIndex == _currentDataSetIndex && _chartSeries && _chart)
         {
-            lv_chart_set_value_by_id(_chart, _chartSeries, hour, newValue);
-
-            for (int i = hour; i < 24; i++)
-            {
-                lv_chart_set_value_by_id(_chart, _chartSeries, i, LV_CHART_POINT_NONE);
-            }
+            invalidateBar(hour);
+            updateChartRange();
         }
-
-        updateChart();
-        updateChartRange();
     }
 
     void updateSettingsTextArea(std::string_view newLine)
@@ -835,23 +876,125 @@ public:
         }
 
         if (_timeLabel && !time.empty())
-            lv_label_set_text(_timeLabel, time.data());
+            setText(_timeLabel, time.data());
         if (_dateLabel && !date.empty())
-            lv_label_set_text(_dateLabel, date.data());
+            setText(_dateLabel, date.data());
     }
 
     void updateTotal(int sol, int cons)
     {
+        char text[24];
         if (_totalSolLabel)
-            lv_label_set_text(_totalSolLabel, Utils::formatPower(sol, "W", "h").c_str());
+        {
+            Utils::formatPower(text, sizeof(text), sol, "W", "h");
+            setText(_totalSolLabel, text);
+        }
         if (_dayConsumpLabel)
-            lv_label_set_text(_dayConsumpLabel, Utils::formatPower(cons, "W", "h").c_str());
+        {
+            Utils::formatPower(text, sizeof(text), cons, "W", "h");
+            setText(_dayConsumpLabel, text);
+        }
     }
 
 private:
     void updateLabel(lv_obj_t *label, int value)
     {
-        lv_label_set_text(label, Utils::formatPower(value).c_str());
+        char text[24];
+        Utils::formatPower(text, sizeof(text), value);
+        setText(label, text);
+    }
+
+    // Keeps the running min/max of a data set, a full rescan is needed only
+    // when the current extreme itself gets smaller.
+    void updateExtremes(ChartDataSet &dataSet, int previous, int value)
+    {
+        int v = (value == LV_CHART_POINT_NONE) ? 0 : value;
+        int p = (previous == LV_CHART_POINT_NONE) ? 0 : previous;
+
+        if (v >= dataSet.max)
+            dataSet.max = v;
+        else if (p == dataSet.max)
+            dataSet.max = scanDataSet(dataSet, true);
+
+        if (v <= dataSet.min)
+            dataSet.min = v;
+        else if (p == dataSet.min)
+            dataSet.min = scanDataSet(dataSet, false);
+    }
+
+    int scanDataSet(const ChartDataSet &dataSet, bool maximum)
+    {
+        int result = 0;
+        for (int i = 0; i < 24; i++)
+        {
+            int value = dataSet.data[i];
+            if (value == LV_CHART_POINT_NONE)
+                continue;
+            result = maximum ? std::max(result, value) : std::min(result, value);
+        }
+        return result;
+    }
+
+    // Invalidates the column of one bar instead of the whole chart, the slot
+    // follows the bar layout of lv_chart (content width split into 24 columns).
+    void invalidateBar(int hour)
+    {
+        lv_area_t area;
+        lv_obj_get_content_coords(_chart, &area);
+        lv_coord_t gap = lv_obj_get_style_pad_column(_chart, LV_PART_MAIN);
+        int32_t width = lv_area_get_width(&area);
+        lv_coord_t left = area.x1;
+
+        area.x1 = left + ((width + gap) * hour) / 24 - 1;
+        area.x2 = left + ((width + gap) * (hour + 1)) / 24 + 1;
+        lv_obj_invalidate_area(_chart, &area);
+    }
+
+    // Setters below compare with the state the widget already renders and call
+    // LVGL only on a difference - every set invalidates the widget area, which is
+    // then rendered and flushed to the panel again.
+    void setText(lv_obj_t *label, const char *text)
+    {
+        if (label && std::strcmp(lv_label_get_text(label), text) != 0)
+            lv_label_set_text(label, text);
+    }
+
+    void setBorderColor(lv_obj_t *obj, lv_color_t color)
+    {
+        if (obj && !lv_color_eq(lv_obj_get_style_border_color(obj, LV_PART_MAIN), color))
+            lv_obj_set_style_border_color(obj, color, 0);
+    }
+
+    void setTextColor(lv_obj_t *obj, lv_color_t color)
+    {
+        if (obj && !lv_color_eq(lv_obj_get_style_text_color(obj, LV_PART_MAIN), color))
+            lv_obj_set_style_text_color(obj, color, 0);
+    }
+
+    void setBgColor(lv_obj_t *obj, lv_color_t color, lv_style_selector_t part)
+    {
+        if (obj && !lv_color_eq(lv_obj_get_style_bg_color(obj, part), color))
+            lv_obj_set_style_bg_color(obj, color, part);
+    }
+
+    void setHidden(lv_obj_t *obj, bool hidden)
+    {
+        if (!obj || lv_obj_has_flag(obj, LV_OBJ_FLAG_HIDDEN) == hidden)
+            return;
+        if (hidden)
+            lv_obj_add_flag(obj, LV_OBJ_FLAG_HIDDEN);
+        else
+            lv_obj_clear_flag(obj, LV_OBJ_FLAG_HIDDEN);
+    }
+
+    void setLed(lv_obj_t *led, lv_color_t color, bool on)
+    {
+        if (!led)
+            return;
+        if (!lv_color_eq(reinterpret_cast<lv_led_t *>(led)->color, color))
+            lv_led_set_color(led, color);
+        if ((lv_led_get_brightness(led) == LV_LED_BRIGHT_MAX) != on)
+            on ? lv_led_on(led) : lv_led_off(led);
     }
 
     void showEnergyBar()
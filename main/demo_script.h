@@ -0,0 +1,97 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2025 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   demo_script.h
+/// @author Petr Vanek
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "mqtt_queue_data.h"
+
+/// @brief Deterministic sequence of inverter values for exercising the dashboard
+///        without a broker: night, sunrise, export with a charging battery, a cloud,
+///        evening discharge. Values are interpolated linearly between key frames,
+///        the toggles (Hdo, grid status) switch at a key frame.
+class DemoScript
+{
+public:
+    struct KeyFrame
+    {
+        uint16_t steps; // updates from the previous key frame
+        int32_t pv1;
+        int32_t pv2;
+        int32_t battery;   // W, + charging
+        int32_t batteryCap; // %
+        int32_t batteryTemp;
+        int32_t feedin;    // W, + export
+        int32_t inverter;  // W, sum of the phases
+        int32_t temperature;
+        int32_t hdo;
+        int32_t gridStatus;
+    };
+
+    static constexpr KeyFrame Script[] = {
+        {1, 0, 0, -300, 80, 18, -150, 450, 25, 0, 0},           // night, battery covers the house
+        {20, 0, 0, -350, 76, 18, -200, 500, 25, 1, 0},          // low tariff
+        {30, 1800, 1500, 800, 79, 21, 1200, 3300, 38, 0, 0},    // sunrise
+        {30, 4200, 3900, 2500, 92, 26, 4800, 8100, 47, 0, 0},   // noon, export and charging
+        {1, 900, 800, 0, 92, 26, -300, 1700, 45, 0, 0},         // cloud - step change
+        {10, 3900, 3600, 1500, 95, 27, 4200, 7500, 46, 0, 0},
+        {30, 600, 400, -800, 88, 22, -600, 1000, 33, 0, 1},     // evening, grid fault
+        {20, 0, 0, -1200, 70, 20, -900, 1200, 27, 0, 0},
+    };
+
+    static constexpr size_t KeyFrames = sizeof(Script) / sizeof(Script[0]);
+
+    /// @brief Next update of the sequence
+    /// @return false when the script is finished
+    bool next(SolaxParameters &params)
+    {
+        if (_key >= KeyFrames)
+        {
+            return false;
+        }
+
+        const KeyFrame &to = Script[_key];
+        const KeyFrame &from = _key ? Script[_key - 1] : to;
+        const int32_t step = _step + 1;
+        auto lerp = [&](int32_t a, int32_t b)
+        { return a + (b - a) * step / to.steps; };
+
+        params.Powerdc1 = lerp(from.pv1, to.pv1);
+        params.Powerdc2 = lerp(from.pv2, to.pv2);
+        params.Batpower_Charge1 = lerp(from.battery, to.battery);
+        params.BattCap = lerp(from.batteryCap, to.batteryCap);
+        params.TemperatureBat = lerp(from.batteryTemp, to.batteryTemp);
+        params.FeedinPower = lerp(from.feedin, to.feedin);
+        params.GridPower_R = lerp(from.inverter, to.inverter) / 3;
+        params.GridPower_S = params.GridPower_R;
+        params.GridPower_T = lerp(from.inverter, to.inverter) - 2 * params.GridPower_R;
+        params.Temperature = lerp(from.temperature, to.temperature);
+        params.Hdo = to.hdo;
+        params.GridStatus = to.gridStatus;
+
+        if (++_step >= to.steps)
+        {
+            _step = 0;
+            ++_key;
+        }
+        return true;
+    }
+
+    /// @brief Total number of updates
+    static constexpr uint32_t length()
+    {
+        uint32_t total = 0;
+        for (const auto &key : Script)
+            total += key.steps;
+        return total;
+    }
+
+private:
+    size_t _key{0};
+    uint16_t _step{0};
+};
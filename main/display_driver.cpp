@@ -18,6 +18,17 @@
 #include "esp_lcd_touch_ft5x06.h"
 #include "esp_lvgl_port.h"
 #include "driver/ledc.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include <cinttypes>
+
+// Utility function to clamp a value between a minimum and maximum
+template <typename T>
+constexpr T clamp(T value, T min, T max)
+{
+    return (value < min) ? min : (value > max) ? max
+                                               : value;
+}
 
 // Initialize the I2C bus for touch IO
 void DisplayDriver::initBus()
@@ -41,14 +52,32 @@ void DisplayDriver::downBus()
     ESP_ERROR_CHECK(i2c_driver_delete(HW_I2C_NUM)); // Delete the I2C driver
 }
 
+DisplayDriver::BufferConfig DisplayDriver::defaultBufferConfig()
+{
+    BufferConfig buffer;
+    buffer.lines = CONFIG_PVVIEW_LCD_BUFFER_LINES;
+#if CONFIG_PVVIEW_LCD_DOUBLE_BUFFER
+    buffer.doubleBuffer = true;
+#else
+    buffer.doubleBuffer = false;
+#endif
+#if CONFIG_PVVIEW_LCD_BUFFER_PSRAM
+    buffer.psram = true;
+#else
+    buffer.psram = false;
+#endif
+    buffer.transferLines = CONFIG_PVVIEW_LCD_TRANSFER_LINES;
+    return buffer;
+}
+
 // Initialize and configure the display driver
-void DisplayDriver::start()
+void DisplayDriver::start(const BufferConfig &buffer)
 {
     ESP_LOGI(TAG, "Starting display driver");
     const lvgl_port_cfg_t lvgl_cfg = ESP_LVGL_PORT_INIT_CONFIG(); // Initialize LVGL
     ESP_ERROR_CHECK(lvgl_port_init(&lvgl_cfg));                   // Initialize the LVGL port
     initBacklight();                                              // Initialize the backlight
-    initDisplay();                                                // Initialize the display
+    initDisplay(buffer);                                          // Initialize the display
     initTouch();                                                  // Initialize the touch panel
 }
 
@@ -80,8 +109,19 @@ void DisplayDriver::initBacklight()
 }
 
 // Initialize the LCD display and configure its settings
-void DisplayDriver::initDisplay()
+void DisplayDriver::initDisplay(BufferConfig buffer)
 {
+#if !CONFIG_SPIRAM
+    if (buffer.psram)
+    {
+        ESP_LOGW(TAG, "No PSRAM - partial display buffer in internal RAM");
+        buffer.psram = false;
+    }
+#endif
+    buffer.lines = buffer.psram ? HW_LCD_V : clamp<uint32_t>(buffer.lines, 10, HW_LCD_V);
+    // a flush is sent in one transfer, the descriptors must cover the whole buffer
+    buffer.transferLines = clamp<uint32_t>(buffer.transferLines, buffer.lines, HW_LCD_V);
+
     esp_lcd_i80_bus_handle_t i80_bus = NULL;
     // Configure the Intel 8080 bus
     esp_lcd_i80_bus_config_t bus_config = {
@@ -90,7 +130,7 @@ void DisplayDriver::initDisplay()
         .clk_src = LCD_CLK_SRC_PLL160M,
         .data_gpio_nums = {HW_LCD_DB0, HW_LCD_DB1, HW_LCD_DB2, HW_LCD_DB3, HW_LCD_DB4, HW_LCD_DB5, HW_LCD_DB6, HW_LCD_DB7},
         .bus_width = HW_LCD_BUS_W,
-        .max_transfer_bytes = HW_LCD_H * 128 * sizeof(uint16_t),
+        .max_transfer_bytes = HW_LCD_H * buffer.transferLines * sizeof(uint16_t),
         .psram_trans_align = 64,
         .sram_trans_align = 4};
 
@@ -129,16 +169,120 @@ void DisplayDriver::initDisplay()
     const lvgl_port_display_cfg_t disp_cfg = {
         .io_handle = io_handle,
         .panel_handle = panel_handle,
-        .buffer_size = HW_LCD_H * 100,
-        .double_buffer = true,
+        .buffer_size = HW_LCD_H * buffer.lines,
+        .double_buffer = buffer.doubleBuffer,
         .hres = HW_LCD_H,
         .vres = HW_LCD_V,
         .monochrome = false,
         .rotation = {.swap_xy = false, .mirror_x = true, .mirror_y = false},
-        .flags = {.buff_dma = true}};
+        .flags = {.buff_dma = !buffer.psram, .buff_spiram = buffer.psram}};
+
+    const auto freeBefore = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
     _disp = lvgl_port_add_disp(&disp_cfg); // Add display to LVGL
+    const uint32_t bufferBytes = HW_LCD_H * buffer.lines * sizeof(lv_color_t);
+    ESP_LOGI(TAG, "Display buffer %s%" PRIu32 " lines (%" PRIu32 " B) in %s, transfer %" PRIu32 " lines, internal RAM used %d B",
+             buffer.doubleBuffer ? "2x " : "", buffer.lines, bufferBytes, buffer.psram ? "PSRAM" : "DMA RAM", buffer.transferLines,
+             static_cast<int>(freeBefore) - static_cast<int>(heap_caps_get_free_size(MALLOC_CAP_INTERNAL)));
+    if (_disp)
+    {
+        _disp->driver->monitor_cb = monitorCallback; // count rendered pixels
+#if CONFIG_PVVIEW_DISPLAY_STATS
+        _stats.bufferBytes = bufferBytes;
+        _stats.bufferCount = buffer.doubleBuffer ? 2 : 1;
+        _stats.bufferPsram = buffer.psram;
+        _stats.transferBytes = HW_LCD_H * buffer.transferLines * sizeof(uint16_t);
+        // time the transfers: our flush wrapper marks the start, our done callback the end
+        _portFlush = _disp->driver->flush_cb;
+        _disp->driver->flush_cb = flushCallback;
+        const esp_lcd_panel_io_callbacks_t cbs = {
+            .on_color_trans_done = flushDone,
+        };
+        ESP_ERROR_CHECK(esp_lcd_panel_io_register_event_callbacks(io_handle, &cbs, _disp->driver));
+#endif
+    }
+}
+
+// Called by LVGL after each refresh
+void DisplayDriver::monitorCallback(lv_disp_drv_t *drv, uint32_t time, uint32_t px)
+{
+    _renderedPixels.fetch_add(px, std::memory_order_relaxed);
+    _renderedFrames.fetch_add(1, std::memory_order_relaxed);
+    _renderedPixelsTotal.fetch_add(px, std::memory_order_relaxed);
+    _renderedTimeMs.fetch_add(time, std::memory_order_relaxed);
+
+#if CONFIG_PVVIEW_DISPLAY_STATS
+    _stats.renderMs.add(time);
+    _stats.frameBytes.add(px * sizeof(lv_color_t));
+
+    // refreshes per second, LVGL renders only invalidated areas so idle seconds are skipped
+    int64_t now = esp_timer_get_time();
+    _fpsFrames++;
+    if (now - _fpsStart >= 1000000)
+    {
+        if (_fpsStart)
+            _stats.fps.add(_fpsFrames);
+        _fpsStart = now;
+        _fpsFrames = 0;
+    }
+#endif
+}
+
+#if CONFIG_PVVIEW_DISPLAY_STATS
+void DisplayDriver::flushCallback(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
+{
+    uint32_t px = lv_area_get_size(area);
+    _stats.flushPx.add(px);
+    _stats.flushedBytes.fetch_add(px * sizeof(lv_color_t), std::memory_order_relaxed);
+    _flushStart.store(esp_timer_get_time(), std::memory_order_relaxed);
+    _portFlush(drv, area, color_map);
+}
+
+bool DisplayDriver::flushDone(esp_lcd_panel_io_handle_t io, esp_lcd_panel_io_event_data_t *edata, void *user_ctx)
+{
+    int64_t start = _flushStart.load(std::memory_order_relaxed);
+    if (start)
+        _stats.flushUs.add(static_cast<uint32_t>(esp_timer_get_time() - start));
+    lv_disp_flush_ready(static_cast<lv_disp_drv_t *>(user_ctx));
+    return false;
+}
+
+DisplayStats::Memory DisplayDriver::memoryStats()
+{
+    DisplayStats::Memory mem;
+    mem.freeInternal = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    mem.minFreeInternal = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+    mem.largestInternal = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+    mem.freeDma = heap_caps_get_free_size(MALLOC_CAP_DMA);
+#if !LV_MEM_CUSTOM
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    mem.lvglUsed = mon.total_size - mon.free_size;
+    mem.lvglFrag = mon.frag_pct;
+#endif
+    return mem;
+}
+
+size_t DisplayDriver::statsJson(char *buffer, size_t size)
+{
+    return _stats.toJson(memoryStats(), buffer, size);
+}
+
+size_t DisplayDriver::statsText(char *buffer, size_t size)
+{
+    return _stats.toText(memoryStats(), buffer, size);
+}
+#else
+size_t DisplayDriver::statsJson(char *buffer, size_t size)
+{
+    return 0;
 }
 
+size_t DisplayDriver::statsText(char *buffer, size_t size)
+{
+    return 0;
+}
+#endif
+
 // Initialize the touch panel
 void DisplayDriver::initTouch()
 {
@@ -166,14 +310,6 @@ void DisplayDriver::initTouch()
     _disp_indev = lvgl_port_add_touch(&touch_cfg);
 }
 
-// Utility function to clamp a value between a minimum and maximum
-template <typename T>
-constexpr T clamp(T value, T min, T max)
-{
-    return (value < min) ? min : (value > max) ? max
-                                               : value;
-}
-
 // Set the brightness of the LCD backlight
 esp_err_t DisplayDriver::setBrightness(int16_t percent)
 {
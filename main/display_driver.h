@@ -6,11 +6,25 @@
 /// @author Petr Vanek
 
 #pragma once
+#include <atomic>
+#include "sdkconfig.h"
 #include "esp_lvgl_port.h"
+#include "display_stats.h"
 
 class DisplayDriver
 {
 public:
+    // LVGL draw buffer layout, defaults from Kconfig (PV View menu)
+    struct BufferConfig
+    {
+        uint32_t lines;         // buffer height, full frame with psram
+        bool doubleBuffer;
+        bool psram;             // full frame in PSRAM instead of internal DMA RAM
+        uint32_t transferLines; // i80 max_transfer_bytes in lines
+    };
+
+    static BufferConfig defaultBufferConfig();
+
     // Initializes the I2C bus used for the touch controller
     void initBus();
 
@@ -18,7 +32,7 @@ public:
     void downBus();
 
     // Starts the display driver by initializing the display, touch, and backlight
-    void start();
+    void start(const BufferConfig &buffer = defaultBufferConfig());
 
     // Stops the display driver, releasing any allocated resources
     void stop();
@@ -40,9 +54,26 @@ public:
     // Unlocks the LVGL drawing buffer
     void unlock() { lvgl_port_unlock(); }
 
+    // Pixels rendered (invalidated and flushed) by LVGL since the previous call
+    uint32_t takeRenderedPixels() { return _renderedPixels.exchange(0, std::memory_order_relaxed); }
+
+    // Number of LVGL refreshes that rendered something
+    static uint32_t renderedFrames() { return _renderedFrames.load(std::memory_order_relaxed); }
+
+    // Running totals for measuring a sequence of updates (differences, wrap safe)
+    static uint32_t renderedPixelsTotal() { return _renderedPixelsTotal.load(std::memory_order_relaxed); }
+    static uint32_t renderedTimeMs() { return _renderedTimeMs.load(std::memory_order_relaxed); }
+
+    // Render/flush statistics as JSON (/stats), 0 when the buffer is too small
+    // or CONFIG_PVVIEW_DISPLAY_STATS is disabled
+    static size_t statsJson(char *buffer, size_t size);
+
+    // Render/flush statistics as a short text for the settings screen
+    static size_t statsText(char *buffer, size_t size);
+
 private:
     // Initializes the display hardware and LVGL integration
-    void initDisplay();
+    void initDisplay(BufferConfig buffer);
 
     // Initializes the touch controller hardware and LVGL integration
     void initTouch();
@@ -50,6 +81,31 @@ private:
     // Configures and initializes the backlight using PWM
     void initBacklight();
 
+    // LVGL monitor callback - called after every refresh with the rendered pixel count
+    static void monitorCallback(lv_disp_drv_t *drv, uint32_t time, uint32_t px);
+
+    // Refresh statistics, written from the LVGL task (single display)
+    static inline std::atomic<uint32_t> _renderedPixels{0};
+    static inline std::atomic<uint32_t> _renderedFrames{0};
+    static inline std::atomic<uint32_t> _renderedPixelsTotal{0};
+    static inline std::atomic<uint32_t> _renderedTimeMs{0};
+
+#if CONFIG_PVVIEW_DISPLAY_STATS
+    // Wraps the lvgl_port flush callback to time the transfer of each area
+    static void flushCallback(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map);
+
+    // Panel IO transfer done - replaces the lvgl_port callback, signals LVGL
+    static bool flushDone(esp_lcd_panel_io_handle_t io, esp_lcd_panel_io_event_data_t *edata, void *user_ctx);
+
+    static DisplayStats::Memory memoryStats();
+
+    static inline DisplayStats _stats;
+    static inline void (*_portFlush)(lv_disp_drv_t *, const lv_area_t *, lv_color_t *){nullptr};
+    static inline std::atomic<int64_t> _flushStart{0};
+    static inline int64_t _fpsStart{0};
+    static inline uint32_t _fpsFrames{0};
+#endif
+
     // Pointer to the LVGL display object
     lv_disp_t *_disp{nullptr};
 
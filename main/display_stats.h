@@ -0,0 +1,176 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2025 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   display_stats.h
+/// @author Petr Vanek
+
+#pragma once
+
+#include <atomic>
+#include <cinttypes>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+
+/// @brief Rolling histogram with power of two buckets: bucket 0 counts 0,
+///        bucket n counts values in [2^(n-1), 2^n). When the window is full
+///        all buckets are halved, so old samples fade out.
+///        Single writer (LVGL task or the LCD done interrupt), any reader.
+class RollingHistogram
+{
+public:
+    static constexpr int Buckets = 20;
+    static constexpr uint32_t Window = 256; // samples between decays
+
+    void add(uint32_t value)
+    {
+        int bucket = value ? 32 - __builtin_clz(value) : 0;
+        if (bucket >= Buckets)
+            bucket = Buckets - 1;
+        _buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        if (value > _max.load(std::memory_order_relaxed))
+            _max.store(value, std::memory_order_relaxed);
+        _last.store(value, std::memory_order_relaxed);
+        _total.fetch_add(1, std::memory_order_relaxed);
+
+        if (++_window >= Window)
+        {
+            _window = 0;
+            for (auto &b : _buckets)
+                b.store(b.load(std::memory_order_relaxed) / 2, std::memory_order_relaxed);
+            _max.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    /// @brief Upper bound of the bucket holding the given percentile (0..100),
+    ///        capped by the maximum of the current window
+    uint32_t percentile(uint32_t pct) const
+    {
+        uint32_t counts[Buckets];
+        uint32_t sum = 0;
+        for (int i = 0; i < Buckets; i++)
+        {
+            counts[i] = _buckets[i].load(std::memory_order_relaxed);
+            sum += counts[i];
+        }
+        if (sum == 0)
+            return 0;
+
+        uint32_t limit = (sum * pct + 99) / 100;
+        uint32_t acc = 0;
+        for (int i = 0; i < Buckets; i++)
+        {
+            acc += counts[i];
+            if (acc >= limit)
+            {
+                uint32_t upper = i ? (1u << i) - 1 : 0;
+                return upper < max() ? upper : max();
+            }
+        }
+        return UINT32_MAX;
+    }
+
+    uint32_t last() const { return _last.load(std::memory_order_relaxed); }
+    uint32_t max() const { return _max.load(std::memory_order_relaxed); }
+    uint32_t total() const { return _total.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint32_t> _buckets[Buckets]{};
+    std::atomic<uint32_t> _max{0};  // since the last decay
+    std::atomic<uint32_t> _last{0};
+    std::atomic<uint32_t> _total{0};
+    uint32_t _window{0};
+};
+
+/// @brief Render and flush statistics of the display
+struct DisplayStats
+{
+    RollingHistogram renderMs;  // LVGL refresh (render + flush) per frame
+    RollingHistogram flushUs;   // one flush_cb area until the transfer is done
+    RollingHistogram flushPx;   // pixels per flush_cb area
+    RollingHistogram fps;       // refreshes per second
+    RollingHistogram frameBytes; // bytes sent to the panel per refresh
+    std::atomic<uint32_t> flushedBytes{0};
+
+    // draw buffer layout (set once at start)
+    uint32_t bufferBytes{0};
+    uint32_t bufferCount{0};
+    bool bufferPsram{false};
+    uint32_t transferBytes{0};
+
+    // heap used by LVGL objects (LV_MEM_CUSTOM - the system heap)
+    struct Memory
+    {
+        uint32_t freeInternal{0};
+        uint32_t minFreeInternal{0};
+        uint32_t largestInternal{0};
+        uint32_t freeDma{0};
+        uint32_t lvglUsed{0}; // 0 with LV_MEM_CUSTOM
+        uint32_t lvglFrag{0}; // %
+    };
+
+    /// @brief Writes the statistics as a JSON object
+    /// @return length, 0 when the buffer is too small
+    size_t toJson(const Memory &mem, char *buffer, size_t size) const
+    {
+        Writer w{buffer, size};
+        w.append("{");
+        histogram(w, "render_ms", renderMs);
+        w.append(",");
+        histogram(w, "flush_us", flushUs);
+        w.append(",");
+        histogram(w, "flush_px", flushPx);
+        w.append(",");
+        histogram(w, "fps", fps);
+        w.append(",");
+        histogram(w, "frame_bytes", frameBytes);
+        w.append(",\"flushed_bytes\":%" PRIu32, flushedBytes.load(std::memory_order_relaxed));
+        w.append(",\"buffer\":{\"bytes\":%" PRIu32 ",\"count\":%" PRIu32 ",\"psram\":%s,\"transfer\":%" PRIu32 "}",
+                 bufferBytes, bufferCount, bufferPsram ? "true" : "false", transferBytes);
+        w.append(",\"mem\":{\"free\":%" PRIu32 ",\"min_free\":%" PRIu32 ",\"largest\":%" PRIu32 ",\"free_dma\":%" PRIu32 ",\"lv_used\":%" PRIu32 ",\"lv_frag\":%" PRIu32 "}}",
+                 mem.freeInternal, mem.minFreeInternal, mem.largestInternal, mem.freeDma, mem.lvglUsed, mem.lvglFrag);
+        return w.failed ? 0 : w.length;
+    }
+
+    /// @brief Short multi line text for the settings screen
+    size_t toText(const Memory &mem, char *buffer, size_t size) const
+    {
+        Writer w{buffer, size};
+        w.append("render %" PRIu32 " ms p90 %" PRIu32 " max %" PRIu32 "\n", renderMs.last(), renderMs.percentile(90), renderMs.max());
+        w.append("flush %" PRIu32 " us p90 %" PRIu32 ", %" PRIu32 " px\n", flushUs.last(), flushUs.percentile(90), flushPx.last());
+        w.append("fps %" PRIu32 " max %" PRIu32 ", %" PRIu32 " B/frame\n", fps.last(), fps.max(), frameBytes.last());
+        w.append("buffer %" PRIu32 "x%" PRIu32 " B %s\n", bufferCount, bufferBytes, bufferPsram ? "PSRAM" : "DMA");
+        w.append("heap %" PRIu32 " min %" PRIu32 " dma %" PRIu32, mem.freeInternal, mem.minFreeInternal, mem.freeDma);
+        return w.failed ? 0 : w.length;
+    }
+
+private:
+    struct Writer
+    {
+        char *buffer;
+        size_t size;
+        size_t length{0};
+        bool failed{false};
+
+        void append(const char *fmt, ...)
+        {
+            if (failed)
+                return;
+            va_list args;
+            va_start(args, fmt);
+            int n = vsnprintf(buffer + length, size - length, fmt, args);
+            va_end(args);
+            if (n < 0 || static_cast<size_t>(n) >= size - length)
+                failed = true;
+            else
+                length += n;
+        }
+    };
+
+    static void histogram(Writer &w, const char *name, const RollingHistogram &h)
+    {
+        w.append("\"%s\":{\"last\":%" PRIu32 ",\"max\":%" PRIu32 ",\"p50\":%" PRIu32 ",\"p90\":%" PRIu32 ",\"p99\":%" PRIu32 ",\"n\":%" PRIu32 "}",
+                 name, h.last(), h.max(), h.percentile(50), h.percentile(90), h.percentile(99), h.total());
+    }
+};
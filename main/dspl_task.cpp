@@ -11,6 +11,9 @@
 #include <math.h>
 #include <stdlib.h>
 #include <ctype.h>
+#include <inttypes.h>
+#include <algorithm>
+#include "esp_timer.h"
 #include "dspl_task.h"
 #include "application.h"
 #include "esp_log.h"
@@ -21,11 +24,6 @@
 DisplayTask::DisplayTask() : _consumption("cons"), _photovoltaic("pv"), _sdcard("/sdcard", HW_SD_MOSI, HW_SD_MISO, HW_SD_CLK, HW_SD_CS)
 {
     _queue = xQueueCreate(5, sizeof(DisplayTask::ReqData));
-    _queueData = xQueueCreate(5, sizeof(SolaxParameters));
-
-    // display adriver init adn attach to lvgl
-    _dd.initBus();
-    _dd.start();
 }
 
 DisplayTask::~DisplayTask()
@@ -33,9 +31,6 @@ DisplayTask::~DisplayTask()
     done();
     if (_queue)
         vQueueDelete(_queue);
-
-    if (_queueData)
-        vQueueDelete(_queueData);
 }
 
 void DisplayTask::loop()
@@ -46,6 +41,7 @@ void DisplayTask::loop()
     bool firstCheck = true;
 
     mountOK = (_sdcard.mount(true) == ESP_OK);
+    _sdMounted = mountOK;
     if (!mountOK)
         ESP_LOGE(TAG, "SD card mount failed - memory mode");
     else
@@ -67,15 +63,22 @@ void DisplayTask::loop()
 
     _dd.unlock();
     _dd.setBrightness(100);
+
+    KeyVal &kv = KeyVal::getInstance();
+    _frameBudgetUs = 1000 * static_cast<int64_t>(kv.readUint32(literals::kv_frame_budget, DefaultFrameBudgetMs));
+    uint32_t maxFps = kv.readUint32(literals::kv_max_fps, DefaultMaxFps);
+    _renderIntervalUs = maxFps ? 1000000 / maxFps : 0;
+
     bool lastMqtt = false;
     bool lastConnection = _connectionManager ? _connectionManager->isConnected() : false;
     Application::getInstance()->signalTaskStart(Application::TaskBit::Display);
 
     while (true)
     {
-        vTaskDelay(1000 / portTICK_PERIOD_MS);
+        // queue, snapshot and connection state are cheap to check on every wake
+        waitEvents();
         ReqData req;
-        if (xQueueReceive(_queue, &req, 0) == pdTRUE)
+        while (xQueueReceive(_queue, &req, 0) == pdTRUE)
         {
             if (req.contnet == Contnet::UpdateData)
             {
@@ -85,25 +88,88 @@ void DisplayTask::loop()
                 _dd.unlock();
             }
         }
-        if (xQueueReceive(_queueData, &_SolaxData, 0) == pdTRUE)
+
+#if CONFIG_PVVIEW_DISPLAY_STATS
+        _dd.lock();
+        if (_dashboard.isSettingsScreenActive())
+        {
+            char stats[256];
+            if (DisplayDriver::statsText(stats, sizeof(stats)))
+                _dashboard.updateStats(stats);
+        }
+        _dd.unlock();
+#endif
+
+        SolaxFrame frame;
+        if (_snapshot.fetch(frame))
         {
-            // update UI data
+            // read outside the log macro - it resets the counter and ESP_LOGD may be compiled out
+            const uint32_t renderedPx = _dd.takeRenderedPixels();
+            _renderedPxSum += renderedPx;
+            ESP_LOGD(TAG, "Frames consumed %" PRIu32 " overwritten %" PRIu32 ", rendered %" PRIu32 " px since the previous frame",
+                     _snapshot.consumed(), _snapshot.overwritten(), renderedPx);
+            _SolaxData = frame.params;
+            // a skipped frame may have carried other changes
+            auto changed = frame.changed;
+            if (_snapshot.overwritten() != _overwritten)
+            {
+                _overwritten = _snapshot.overwritten();
+                changed = SolaxFields::all;
+            }
+            auto any = [changed](auto... members)
+            { return (changed & SolaxFields::maskOf(members...)) != 0; };
+
+            // update UI data - tiles whose inputs did not move past their deadband are skipped
             _dd.lock();
-            _dashboard.hdoUpdate(_SolaxData.Hdo);
-            _dashboard.updateSolarPanels(_SolaxData.Powerdc1, _SolaxData.Powerdc2);
-            _dashboard.updateBattery(_SolaxData.BattCap, _SolaxData.Batpower_Charge1, _SolaxData.TemperatureBat);
+            if (any(&SolaxParameters::Hdo))
+                _dashboard.hdoUpdate(_SolaxData.Hdo);
+            if (any(&SolaxParameters::Powerdc1, &SolaxParameters::Powerdc2))
+                _dashboard.updateSolarPanels(_SolaxData.Powerdc1, _SolaxData.Powerdc2);
+            if (any(&SolaxParameters::BattCap, &SolaxParameters::Batpower_Charge1, &SolaxParameters::TemperatureBat))
+                _dashboard.updateBattery(_SolaxData.BattCap, _SolaxData.Batpower_Charge1, _SolaxData.TemperatureBat);
             auto inverterTotal = _SolaxData.GridPower_R + _SolaxData.GridPower_S + _SolaxData.GridPower_T;
             auto consumption = inverterTotal - _SolaxData.FeedinPower;
             auto photovoltaic = _SolaxData.Powerdc1 + _SolaxData.Powerdc2;
             auto freeEnergy = photovoltaic - consumption;
 
-            _dashboard.updateConsumption(consumption);
-            _dashboard.updateGrid(_SolaxData.FeedinPower, (_SolaxData.GridStatus == 0));
-            _dashboard.updateOverview(inverterTotal, _SolaxData.Temperature);
-            _dashboard.updateEnergyBar(freeEnergy);
+            const bool grid = any(&SolaxParameters::GridPower_R, &SolaxParameters::GridPower_S, &SolaxParameters::GridPower_T);
+            const bool pv = any(&SolaxParameters::Powerdc1, &SolaxParameters::Powerdc2);
+            if (grid || any(&SolaxParameters::FeedinPower))
+                _dashboard.updateConsumption(consumption);
+            if (any(&SolaxParameters::FeedinPower, &SolaxParameters::GridStatus))
+                _dashboard.updateGrid(_SolaxData.FeedinPower, (_SolaxData.GridStatus == 0));
+            if (grid || any(&SolaxParameters::Temperature))
+                _dashboard.updateOverview(inverterTotal, _SolaxData.Temperature);
+            if (grid || pv || any(&SolaxParameters::FeedinPower))
+                _dashboard.updateEnergyBar(freeEnergy);
+
+            // tiles whose inputs stopped arriving
+            auto stale = [&frame](auto... members)
+            { return (frame.stale & SolaxFields::maskOf(members...)) != 0; };
+            const bool gridStale = stale(&SolaxParameters::GridPower_R, &SolaxParameters::GridPower_S, &SolaxParameters::GridPower_T, &SolaxParameters::FeedinPower);
+            const bool pvStale = stale(&SolaxParameters::Powerdc1, &SolaxParameters::Powerdc2);
+            _dashboard.setTileStale(Dashboard::Tile::Solar, pvStale);
+            _dashboard.setTileStale(Dashboard::Tile::Battery, stale(&SolaxParameters::BattCap, &SolaxParameters::Batpower_Charge1, &SolaxParameters::TemperatureBat));
+            _dashboard.setTileStale(Dashboard::Tile::Grid, stale(&SolaxParameters::FeedinPower, &SolaxParameters::GridStatus));
+            _dashboard.setTileStale(Dashboard::Tile::Consumption, gridStale);
+            _dashboard.setTileStale(Dashboard::Tile::Overview, gridStale || stale(&SolaxParameters::Temperature));
+            _dashboard.setTileStale(Dashboard::Tile::EnergyBar, gridStale || pvStale);
+
+            // energy, day files and metrics from the values as received, the
+            // conditioned ones (smoothing, deadband, decimation) are for the widgets
+            const auto &raw = frame.raw;
+            const int32_t rawInverterTotal = raw.GridPower_R + raw.GridPower_S + raw.GridPower_T;
+            const int32_t rawConsumption = rawInverterTotal - raw.FeedinPower;
+            const int32_t rawPhotovoltaic = raw.Powerdc1 + raw.Powerdc2;
+
+            DerivedMetrics metrics;
+            metrics.consumption = rawConsumption;
+            metrics.photovoltaic = rawPhotovoltaic;
+            metrics.freeEnergy = rawPhotovoltaic - rawConsumption;
+            metrics.inverterTotal = rawInverterTotal;
 
             auto [dt, tm] = Utils::getDateTime();
-            ESP_LOGI(TAG, "Utils::getDateTime %s %s", dt.c_str(), tm.c_str());
+            ESP_LOGD(TAG, "Utils::getDateTime %s %s", dt.c_str(), tm.c_str());
             _dashboard.updateDateTime(dt, tm);
             // ---> valid time
             if (_connectionManager && _connectionManager->isTimeActive())
@@ -138,18 +204,32 @@ void DisplayTask::loop()
                                                   { _dashboard.updateDataSetHour(0, hour, consumption); });
                     }
 
-                    _consumption.update(consumption);
-                    _photovoltaic.update(photovoltaic);
+                    // stale inputs are not integrated, replay / demo values never
+                    if (gridStale || frame.synthetic)
+                        _consumption.pause();
+                    else
+                        _consumption.update(rawConsumption);
+                    if (pvStale || frame.synthetic)
+                        _photovoltaic.pause();
+                    else
+                        _photovoltaic.update(rawPhotovoltaic);
 
                     //ESP_LOGI(TAG, "Total %ld  Sol %ld", (int32_t)_photovoltaic.getSum(), (int32_t)_consumption.getSum());
-                    _dashboard.updateTotal((_SolaxData.Etoday_togrid/10)*1000 /* _photovoltaic.getSum()*/, (int)_consumption.getSum());
+                    _dashboard.updateTotal((raw.Etoday_togrid/10)*1000 /* _photovoltaic.getSum()*/, (int)_consumption.getSum());
                     _dashboard.updateDataSetHour(1, hour, _consumption.getConsumptionForHour(hour));
                     _dashboard.updateDataSetHour(0, hour, _photovoltaic.getConsumptionForHour(hour));
 
+                    metrics.hourlyValid = 1;
+                    for (int i = 0; i < 24; ++i)
+                    {
+                        metrics.hourlyConsumption[i] = _consumption.getConsumptionForHour(i);
+                        metrics.hourlyPhotovoltaic[i] = _photovoltaic.getConsumptionForHour(i);
+                    }
+
                     // if (sec == 0 || sec == 20 || sec == 40)
-                    ESP_LOGI(TAG, "TIME %d %d %d", hour, min, sec);
+                    ESP_LOGD(TAG, "TIME %d %d %d", hour, min, sec);
 
-                    if (mountOK && (min % 5 == 0) && (lastMin != min))
+                    if (mountOK && !frame.synthetic && (min % 5 == 0) && (lastMin != min))
                     {
                         lastMin = min;
                         auto filename = "/" + Utils::getDayFileName();
@@ -168,6 +248,24 @@ void DisplayTask::loop()
             } // <--- valid time
 
             _dd.unlock();
+            if (!frame.synthetic)
+                _metrics.publish(metrics);
+
+            // widgets are updated, LVGL draws them on its next refresh
+            _lastRender = esp_timer_get_time();
+            int64_t dataAt = _dataAt.exchange(0);
+            if (dataAt)
+            {
+                _latencySum += _lastRender - dataAt;
+                if (++_latencyCount == 60)
+                {
+                    ESP_LOGI(TAG, "Data to widget latency %" PRId64 " ms, %" PRIu64 " px rendered per frame (avg of %" PRIu32 ")",
+                             _latencySum / _latencyCount / 1000, _renderedPxSum / _latencyCount, _latencyCount);
+                    _latencySum = 0;
+                    _latencyCount = 0;
+                    _renderedPxSum = 0;
+                }
+            }
         }
 
         // chcek connection error
@@ -227,21 +325,65 @@ void DisplayTask::settingMsg(std::string_view msg)
         std::memcpy(rqdt.msg, msg.data(), copyLength);
         rqdt.msg[copyLength] = '\0';
         xQueueSendToBack(_queue, &rqdt, 0);
+        if (task())
+            xTaskNotify(task(), NotifyMsg, eSetBits);
     }
 }
 
-void DisplayTask::updateUI(const SolaxParameters &msg)
+void DisplayTask::updateUI(const SolaxFrame &msg)
 {
-    if (_queueData)
+    // newest snapshot wins, an unread one is overwritten
+    _snapshot.publish(msg);
+    int64_t none = 0;
+    _dataAt.compare_exchange_strong(none, esp_timer_get_time());
+    if (task())
+        xTaskNotify(task(), NotifyData, eSetBits);
+}
+
+uint32_t DisplayTask::waitEvents()
+{
+    uint32_t events = 0;
+    xTaskNotifyWait(0, UINT32_MAX, &events, pdMS_TO_TICKS(TickMs));
+    if (!(events & NotifyData))
+    {
+        return events;
+    }
+
+    // a burst of frames (several inverters, replay) is rendered once
+    int64_t now = esp_timer_get_time();
+    int64_t due = std::max(now + _frameBudgetUs, _lastRender + _renderIntervalUs);
+    while (now < due)
     {
-        xQueueSendToBack(_queueData, &msg, 0);
+        uint32_t more = 0;
+        TickType_t wait = std::max<TickType_t>(1, pdMS_TO_TICKS((due - now + 999) / 1000));
+        if (xTaskNotifyWait(0, UINT32_MAX, &more, wait) == pdTRUE)
+        {
+            events |= more;
+        }
+        now = esp_timer_get_time();
     }
+    return events;
 }
 
 bool DisplayTask::init(std::shared_ptr<ConnectionManager> connMgr, const char *name, UBaseType_t priority, const configSTACK_DEPTH_TYPE stackDepth)
 {
     bool rc = false;
     _connectionManager = connMgr;
+
+    // display driver init and attach to lvgl - after NVS, the buffer layout can be overridden there
+    KeyVal &kv = KeyVal::getInstance();
+    auto buffer = DisplayDriver::defaultBufferConfig();
+    buffer.lines = kv.readUint32(literals::kv_lcd_lines, buffer.lines);
+    buffer.doubleBuffer = kv.readUint32(literals::kv_lcd_double, buffer.doubleBuffer) != 0;
+    buffer.psram = kv.readUint32(literals::kv_lcd_psram, buffer.psram) != 0;
+    buffer.transferLines = kv.readUint32(literals::kv_lcd_transfer, buffer.transferLines);
+    _dd.initBus();
+    _dd.start(buffer);
+
     rc = RPTask::init(name, priority, stackDepth);
+    if (rc && _connectionManager)
+    {
+        _connectionManager->setListener(task(), NotifyConnection);
+    }
     return rc;
 }
\ No newline at end of file
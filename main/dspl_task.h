@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "hardware.h"
 #include "rptask.h"
 #include "display_driver.h"
@@ -15,6 +17,8 @@
 #include "mqtt_queue_data.h"
 #include "shoelace.h"
 #include "sd_card.h"
+#include "snapshot_mailbox.h"
+#include "metrics_publisher.h"
 
 class DisplayTask : public RPTask
 {
@@ -34,25 +38,50 @@ public:
 		char msg[50]; 
 	};
 
+	// task notification bits
+	static constexpr uint32_t NotifyData = 1u << 0;		  // new snapshot
+	static constexpr uint32_t NotifyMsg = 1u << 1;		  // setting message queued
+	static constexpr uint32_t NotifyConnection = 1u << 2; // ConnectionManager state changed
+
+	static constexpr uint32_t DefaultFrameBudgetMs = 20; // burst of frames rendered once
+	static constexpr uint32_t DefaultMaxFps = 10;		  // render rate cap
+	static constexpr uint32_t TickMs = 1000;			  // periodic wake without events
+
 	DisplayTask();
 	virtual ~DisplayTask();
 	void settingMsg(std::string_view msg);
-	void updateUI(const SolaxParameters& msg);
+	void updateUI(const SolaxFrame& frame);
+	bool fetchMetrics(DerivedMetrics &metrics) { return _metrics.fetch(metrics); }
+	bool isSdCardMounted() const { return _sdMounted; }
 	bool init(std::shared_ptr<ConnectionManager> connMgr, const char *name, UBaseType_t priority, const configSTACK_DEPTH_TYPE stackDepth);
 
 protected:
 	void loop() override;
 
+	// Blocks until an event; data is coalesced for the frame budget and
+	// delayed to keep the render rate cap. Returns the notification bits.
+	uint32_t waitEvents();
+
 private:
 	static constexpr const char *TAG = "DisplayTask";
 	QueueHandle_t 	_queue;
-	QueueHandle_t 	_queueData;
+	SnapshotMailbox<SolaxFrame> _snapshot;	// latest data from MQTT
+	SnapshotMailbox<DerivedMetrics> _metrics;	// computed values for MqttTask
 	DisplayDriver _dd;
     Dashboard _dashboard;
 	std::shared_ptr<ConnectionManager> _connectionManager;
 	SolaxParameters  _SolaxData;
+	uint32_t		 _overwritten{0}; // _snapshot.overwritten() seen last time
 	Shoelace		 _consumption;
 	Shoelace         _photovoltaic;
 	SdCard			 _sdcard;
+	std::atomic<bool> _sdMounted{false};
+	int64_t			 _frameBudgetUs{DefaultFrameBudgetMs * 1000};
+	int64_t			 _renderIntervalUs{1000000 / DefaultMaxFps};
+	int64_t			 _lastRender{0};
+	std::atomic<int64_t> _dataAt{0}; // first snapshot not rendered yet (esp_timer, us)
+	int64_t			 _latencySum{0};
+	uint32_t		 _latencyCount{0};
+	uint64_t		 _renderedPxSum{0}; // invalidated pixels over the latency window
 	
 };
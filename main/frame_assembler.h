@@ -0,0 +1,68 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2024 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   frame_assembler.h
+/// @author Petr Vanek
+
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+#include "solax_fields.h"
+
+/// @brief Collects per-field updates into complete frames.
+///        A frame is complete once every expected field has arrived, or when
+///        the first update of the frame is older than the timeout. The expected
+///        set follows what the gateway really sends - fields missing from a
+///        timed out frame are dropped from it, fields seen again are re-added.
+class FrameAssembler
+{
+public:
+    static constexpr uint32_t DefaultTimeoutMs = 2000;
+
+    explicit FrameAssembler(TickType_t timeout = pdMS_TO_TICKS(DefaultTimeoutMs)) : _timeout(timeout) {}
+
+    void setTimeout(TickType_t timeout) { _timeout = timeout; }
+
+    /// @brief Records updated fields
+    /// @param updated mask of fields carried by one message
+    /// @param now current tick count
+    /// @return true when the frame is ready to be published (call reset() after)
+    bool add(SolaxFields::Mask updated, TickType_t now)
+    {
+        if (!updated)
+            return false;
+
+        if (!_seen)
+            _frameStart = now;
+
+        _seen |= updated;
+        return complete() || expired(now);
+    }
+
+    /// @brief All expected fields of the current frame arrived
+    bool complete() const { return _seen && (_seen & _expected) == _expected; }
+
+    /// @brief Partial frame waits longer than the timeout
+    bool expired(TickType_t now) const { return _seen && (now - _frameStart) >= _timeout; }
+
+    /// @brief Closes the current frame and adapts the expected field set
+    void reset()
+    {
+        if (complete())
+            _expected |= _seen; // fields seen beyond the expected set
+        else if (_seen)
+            _expected = _seen; // timed out, the gateway does not send the rest
+
+        _seen = 0;
+    }
+
+    SolaxFields::Mask seen() const { return _seen; }
+    SolaxFields::Mask expected() const { return _expected; }
+
+private:
+    TickType_t _timeout;
+    TickType_t _frameStart{0};
+    SolaxFields::Mask _seen{0};
+    SolaxFields::Mask _expected{SolaxFields::all};
+};
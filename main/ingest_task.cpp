@@ -0,0 +1,359 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2024 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   ingest_task.cpp
+/// @author Petr Vanek
+
+#include <cinttypes>
+#include "ingest_task.h"
+#include "literals.h"
+#include "application.h"
+#include "mqtt.h"
+#include "json_serializer.h"
+#include "solax_binary.h"
+#include "demo_script.h"
+#include "key_val.h"
+#include "shoelace.h"
+#include "esp_timer.h"
+
+// a reassembled payload from one inverter topic must fit the ring
+static_assert(Mqtt::MaxFragmentedPayload + InverterAggregator::MaxIdLength <= SpscRing<IngestTask::RingSize>::maxRecord(),
+              "Mqtt::MaxFragmentedPayload does not fit IngestTask ring");
+
+IngestTask::IngestTask()
+{
+}
+
+IngestTask::~IngestTask()
+{
+    done();
+}
+
+bool IngestTask::init(const char *name, UBaseType_t priority, const configSTACK_DEPTH_TYPE stackDepth)
+{
+    return RPTask::init(name, priority, stackDepth);
+}
+
+bool IngestTask::push(std::string_view topic, std::string_view message)
+{
+    // no logging here - this is the esp-mqtt task, drops are counted by the ring
+    // and reported by loop()
+    if (!_ring.push(topic, message))
+    {
+        return false;
+    }
+
+    if (task())
+    {
+        xTaskNotifyGive(task());
+    }
+    return true;
+}
+
+void IngestTask::commitFrame(int index)
+{
+    auto &inverter = _inverters.inverter(index);
+    if (!inverter.frame.complete())
+    {
+        ESP_LOGD(LOG_TAG, "Frame timeout [%.*s], fields 0x%08" PRIx32 " of 0x%08" PRIx32,
+                 static_cast<int>(inverter.name().size()), inverter.name().data(), inverter.frame.seen(), inverter.frame.expected());
+    }
+    inverter.frame.reset();
+    _inverters.commit(index);
+}
+
+bool IngestTask::onMessage(std::string_view topic, std::string_view message)
+{
+    // every source topic is one inverter
+    auto index = _inverters.find(topic);
+    if (index < 0)
+    {
+        ESP_LOGW(LOG_TAG, "No slot for inverter [%.*s]", static_cast<int>(topic.size()), topic.data());
+        return false;
+    }
+
+    auto &inverter = _inverters.inverter(index);
+    auto updated = SolaxBinary::isFrame(message) ? SolaxBinary::decode(inverter.data, message)
+                                                 : JsonSerializer::updateParametersFromJson(inverter.data, message);
+    _arrival.stamp(updated, xTaskGetTickCount());
+    if (inverter.frame.add(updated, xTaskGetTickCount()))
+    {
+        commitFrame(index);
+        return true;
+    }
+    return false;
+}
+
+void IngestTask::publishSite()
+{
+    publishSite(_inverters.site());
+}
+
+void IngestTask::publishSite(const SolaxParameters &site)
+{
+    _frame = _conditioner.process(site);
+    publishFrame();
+}
+
+void IngestTask::publishStale()
+{
+    // no new sample - the conditioner (EMA, decimation) must not advance
+    _frame.changed = 0;
+    publishFrame();
+}
+
+void IngestTask::publishFrame()
+{
+    _stale = _arrival.stale(xTaskGetTickCount(), _staleAge);
+    _frame.stale = _stale;
+    _frame.times = _arrival;
+    _frame.synthetic = _synthetic;
+    Application::getInstance()->getDisplayTask()->updateUI(_frame);
+}
+
+void IngestTask::recordMessage(std::string_view topic, std::string_view message)
+{
+    if (_recordPath.empty())
+    {
+        return;
+    }
+
+    if (!_recording.isOpen())
+    {
+        if (!Application::getInstance()->getDisplayTask()->isSdCardMounted() || !_recording.create(_recordPath))
+        {
+            _recordPath.clear(); // no card - recording off
+            return;
+        }
+        ESP_LOGI(LOG_TAG, "Recording MQTT traffic to %s", _recordPath.c_str());
+    }
+
+    _recording.append(static_cast<uint32_t>(esp_timer_get_time() / 1000), topic, message);
+}
+
+void IngestTask::replay(const std::string &path, uint32_t speed)
+{
+    // the card is mounted by DisplayTask
+    for (int i = 0; i < 50 && !Application::getInstance()->getDisplayTask()->isSdCardMounted(); ++i)
+    {
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+
+    MqttRecording recording;
+    if (!recording.open(path))
+    {
+        return;
+    }
+
+    ESP_LOGW(LOG_TAG, "Replay %s at %" PRIu32 "x (0 - full speed), live data is dropped meanwhile", path.c_str(), speed);
+    const auto start = esp_timer_get_time();
+    const auto startTick = xTaskGetTickCount();
+
+    // shown on the display only - the day totals are integrated here, over the
+    // recording time, never by DisplayTask (see SolaxFrame::synthetic)
+    _synthetic = true;
+    Shoelace pv("replay-pv");
+    Shoelace consumption("replay-cons");
+    uint32_t frames = 0;
+    uint32_t lastMs = 0;
+
+    MqttRecording::Record message;
+    while (recording.next(message))
+    {
+        if (speed)
+        {
+            // 64 bit - pdMS_TO_TICKS multiplies in TickType_t and wraps after ~71 min at 1 kHz
+            const TickType_t due = startTick + static_cast<TickType_t>(static_cast<uint64_t>(message.timeMs / speed) * configTICK_RATE_HZ / 1000);
+            const TickType_t now = xTaskGetTickCount();
+            if (static_cast<int32_t>(due - now) > 0)
+            {
+                vTaskDelay(due - now);
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(_dataMutex);
+        lastMs = message.timeMs;
+        if (!onMessage(message.topic, message.payload))
+        {
+            continue;
+        }
+
+        const auto &site = _inverters.site();
+        pv.update(site.Powerdc1 + site.Powerdc2, message.timeMs / 1000);
+        consumption.update(site.GridPower_R + site.GridPower_S + site.GridPower_T - site.FeedinPower, message.timeMs / 1000);
+        ++frames;
+        publishSite();
+    }
+
+    // live data starts from scratch, replayed topics must not stay in the site total
+    {
+        std::lock_guard<std::mutex> lock(_dataMutex);
+        _synthetic = false;
+        _inverters.clear();
+        _arrival = FieldTimes{};
+        _conditioner.reset();
+        _frame = SolaxFrame{}; // a stale-only update must not re-send synthetic values
+    }
+
+    const auto elapsedUs = esp_timer_get_time() - start;
+    const auto count = recording.count();
+    ESP_LOGW(LOG_TAG, "Replay done: %" PRIu32 " messages, %" PRIu32 " frames in %" PRId64 " ms, %.1f msg/s",
+             count, frames, elapsedUs / 1000, elapsedUs ? count * 1e6 / elapsedUs : 0.0);
+    ESP_LOGW(LOG_TAG, "Replay recorded time %" PRIu32 " s, PV %.1f Wh, consumption %.1f Wh",
+             lastMs / 1000, pv.getSum(), consumption.getSum());
+}
+
+void IngestTask::demo(uint32_t intervalMs)
+{
+    DemoScript script;
+    SolaxParameters params;
+    ESP_LOGW(LOG_TAG, "Demo feed: %" PRIu32 " updates every %" PRIu32 " ms, live data is dropped meanwhile", DemoScript::length(), intervalMs);
+
+    // render cost of every update - the display renders within the interval
+    uint32_t updates = 0;
+    uint32_t worstMs = 0;
+    uint32_t worstStep = 0;
+    const uint32_t firstPx = DisplayDriver::renderedPixelsTotal();
+    const uint32_t firstMs = DisplayDriver::renderedTimeMs();
+    const uint32_t firstFrames = DisplayDriver::renderedFrames();
+    {
+        // demo values are shown only - no energy totals, day files or metrics
+        std::lock_guard<std::mutex> lock(_dataMutex);
+        _synthetic = true;
+    }
+    while (script.next(params))
+    {
+        const uint32_t px = DisplayDriver::renderedPixelsTotal();
+        const uint32_t ms = DisplayDriver::renderedTimeMs();
+        {
+            std::lock_guard<std::mutex> lock(_dataMutex);
+            _arrival.stamp(SolaxFields::all, xTaskGetTickCount());
+            publishSite(params);
+        }
+        vTaskDelay(pdMS_TO_TICKS(intervalMs));
+
+        const uint32_t stepMs = DisplayDriver::renderedTimeMs() - ms;
+        ESP_LOGD(LOG_TAG, "Demo %" PRIu32 ": %" PRIu32 " px in %" PRIu32 " ms", updates, DisplayDriver::renderedPixelsTotal() - px, stepMs);
+        if (stepMs > worstMs)
+        {
+            worstMs = stepMs;
+            worstStep = updates;
+        }
+        ++updates;
+    }
+
+    // the demo stamped every field, live data starts from scratch
+    {
+        std::lock_guard<std::mutex> lock(_dataMutex);
+        _synthetic = false;
+        _arrival = FieldTimes{};
+        _conditioner.reset();
+        _frame = SolaxFrame{}; // a stale-only update must not re-send synthetic values
+    }
+
+    const uint32_t totalPx = DisplayDriver::renderedPixelsTotal() - firstPx;
+    const uint32_t totalMs = DisplayDriver::renderedTimeMs() - firstMs;
+    ESP_LOGW(LOG_TAG, "Demo done: %" PRIu32 " updates, %" PRIu32 " refreshes, avg %" PRIu32 " px and %" PRIu32 " ms per update, worst %" PRIu32 " ms (update %" PRIu32 ")",
+             updates, DisplayDriver::renderedFrames() - firstFrames, updates ? totalPx / updates : 0, updates ? totalMs / updates : 0, worstMs, worstStep);
+}
+
+bool IngestTask::getInverter(int index, SolaxParameters &data)
+{
+    std::lock_guard<std::mutex> lock(_dataMutex);
+    if (index < 0 || index >= _inverters.count())
+    {
+        return false;
+    }
+    data = _inverters.inverter(index).committed;
+    return true;
+}
+
+int IngestTask::inverterCount()
+{
+    std::lock_guard<std::mutex> lock(_dataMutex);
+    return _inverters.count();
+}
+
+void IngestTask::loop()
+{
+    KeyVal &kv = KeyVal::getInstance();
+    _inverters.setTimeout(pdMS_TO_TICKS(kv.readUint32(literals::kv_frame_timeout, FrameAssembler::DefaultTimeoutMs)));
+    _conditioner.configure(kv.readString(literals::kv_signal, literals::kv_def_signal));
+    _staleAge = pdMS_TO_TICKS(1000 * kv.readUint32(literals::kv_stale, DefaultStaleSec));
+    publishSite();
+    Application::getInstance()->signalTaskStart(Application::TaskBit::Ingest);
+
+    _recordPath = kv.readString(literals::kv_record);
+    if (!_recordPath.empty())
+    {
+        _recordPath = "/sdcard/" + _recordPath;
+    }
+
+    auto replayFile = kv.readString(literals::kv_replay);
+    if (!replayFile.empty())
+    {
+        replay("/sdcard/" + replayFile, kv.readUint32(literals::kv_replay_speed, 1));
+    }
+
+    auto demoInterval = kv.readUint32(literals::kv_demo, 0);
+    if (demoInterval)
+    {
+        demo(demoInterval);
+    }
+
+    while (true)
+    {
+        // wake on new data, or once a second for partial frames
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+
+        bool changed = false;
+        bool pending = true;
+        while (pending)
+        {
+            std::lock_guard<std::mutex> lock(_dataMutex);
+            SpscRing<RingSize>::Record record;
+            size_t batch = 0;
+            while (batch < MaxBatch && _ring.peek(record))
+            {
+                recordMessage(record.topic, record.payload);
+                changed |= onMessage(record.topic, record.payload);
+                _ring.pop();
+                ++batch;
+            }
+            pending = batch == MaxBatch;
+
+            // partial frame - the rest of the fields did not arrive in time
+            for (int i = 0; i < _inverters.count(); ++i)
+            {
+                if (_inverters.inverter(i).frame.expired(xTaskGetTickCount()))
+                {
+                    commitFrame(i);
+                    changed = true;
+                }
+            }
+        }
+
+        _recording.flush();
+
+        const uint32_t drops = _ring.drops();
+        if (drops != _reportedDrops)
+        {
+            ESP_LOGW(LOG_TAG, "Ring full, %" PRIu32 " messages dropped (%" PRIu32 " total)", drops - _reportedDrops, drops);
+            _reportedDrops = drops;
+        }
+
+        // one display update per drained batch, or when a field went stale
+        const bool staleChanged = _arrival.stale(xTaskGetTickCount(), _staleAge) != _stale;
+        if (changed || staleChanged)
+        {
+            if (changed)
+                publishSite();
+            else
+                publishStale();
+            ESP_LOGD(LOG_TAG, "Ring used %u, high water %u of %u, pushed %" PRIu32 ", dropped %" PRIu32,
+                     static_cast<unsigned>(_ring.used()), static_cast<unsigned>(_ring.highWater()),
+                     static_cast<unsigned>(_ring.capacity()), _ring.pushed(), _ring.drops());
+        }
+    }
+}
@@ -0,0 +1,73 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2024 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   ingest_task.h
+/// @author Petr Vanek
+
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include "hardware.h"
+#include "rptask.h"
+#include "spsc_ring.h"
+#include "inverter_aggregator.h"
+#include "signal_conditioner.h"
+#include "mqtt_recording.h"
+
+/// @brief Parses MQTT payloads outside of the esp-mqtt client task.
+///        The event handler only copies the raw message into the ring,
+///        this task drains it in batches and feeds the display.
+class IngestTask : public RPTask
+{
+public:
+	static constexpr size_t RingSize = 4096;
+	static constexpr size_t MaxBatch = 16;
+	static constexpr uint32_t DefaultStaleSec = 30; // field without update is shown as stale
+
+	IngestTask();
+	virtual ~IngestTask();
+	bool init(const char *name, UBaseType_t priority = tskIDLE_PRIORITY, const configSTACK_DEPTH_TYPE stackDepth = configMINIMAL_STACK_SIZE);
+
+	// producer side - esp-mqtt client task, never blocks
+	bool push(std::string_view topic, std::string_view message);
+
+	// per-inverter details, the display shows the site total
+	int inverterCount();
+	bool getInverter(int index, SolaxParameters &data);
+
+	// ring statistics
+	size_t ringUsed() const { return _ring.used(); }
+	size_t ringHighWater() const { return _ring.highWater(); }
+	uint32_t ringDrops() const { return _ring.drops(); }
+
+protected:
+	void loop() override;
+	bool onMessage(std::string_view topic, std::string_view message);
+	void commitFrame(int index);
+	void publishSite();
+	void publishSite(const SolaxParameters &site);
+	void publishStale();	// last frame again, only the stale mask changed
+	void publishFrame();
+	void recordMessage(std::string_view topic, std::string_view message);
+	void replay(const std::string &path, uint32_t speed);
+	void demo(uint32_t intervalMs);
+
+private:
+	static constexpr const char *LOG_TAG = "IngestTask";
+	SpscRing<RingSize> _ring;
+	uint32_t _reportedDrops{0};	// _ring.drops() already logged
+	InverterAggregator _inverters; // one slot per source topic
+	SignalConditioner _conditioner; // site values -> UI
+	SolaxFrame _frame;				// last conditioned frame, re-sent when only staleness changes
+	FieldTimes _arrival;			// per-field arrival from any inverter
+	SolaxFields::Mask _stale{0};	// published with the last frame
+	TickType_t _staleAge{0};
+	bool _synthetic{false};			// replay / demo running, frames are not accounted
+	MqttRecording _recording;		// raw traffic to the SD card (KV record)
+	std::string _recordPath;
+	std::mutex _dataMutex;		   // _inverters - ingest loop vs. getInverter
+};
@@ -0,0 +1,145 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2024 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   inverter_aggregator.h
+/// @author Petr Vanek
+
+#pragma once
+
+#include <array>
+#include <cstring>
+#include <string_view>
+#include "mqtt_queue_data.h"
+#include "solax_fields.h"
+#include "frame_assembler.h"
+
+/// @brief Per-inverter snapshots keyed by source (MQTT topic) and the site
+///        snapshot combined from them (see SolaxFields::Aggregate). Committing
+///        an inverter re-sums only its own contribution.
+class InverterAggregator
+{
+public:
+    static constexpr int MaxInverters = 4;
+    static constexpr size_t MaxIdLength = 64;
+
+    struct Inverter
+    {
+        std::array<char, MaxIdLength> id{};
+        size_t idLength{0};
+        SolaxParameters data{};      // being assembled from incoming messages
+        SolaxParameters committed{}; // last complete frame, contributes to the site
+        FrameAssembler frame{};
+        bool contributes{false};
+
+        std::string_view name() const { return std::string_view(id.data(), idLength); }
+    };
+
+    /// @brief Index of the inverter publishing under id, a new one is added for unknown id
+    /// @return index, -1 when all slots are taken or id is too long
+    int find(std::string_view id)
+    {
+        for (int i = 0; i < _count; ++i)
+        {
+            if (_inverters[i].name() == id)
+                return i;
+        }
+
+        if (_count == MaxInverters || id.size() > MaxIdLength)
+            return -1;
+
+        Inverter &inverter = _inverters[_count];
+        std::memcpy(inverter.id.data(), id.data(), id.size());
+        inverter.idLength = id.size();
+        inverter.frame.setTimeout(_timeout);
+        return _count++;
+    }
+
+    int count() const { return _count; }
+
+    /// @brief Forgets all inverters and the site snapshot, the frame timeout is kept
+    void clear()
+    {
+        _inverters.fill(Inverter{});
+        _count = 0;
+        _contributing = 0;
+        _sums.fill(0);
+        _site = SolaxParameters{};
+    }
+
+    Inverter &inverter(int index) { return _inverters[index]; }
+    const Inverter &inverter(int index) const { return _inverters[index]; }
+
+    /// @brief Frame timeout for current and future inverters
+    void setTimeout(TickType_t timeout)
+    {
+        _timeout = timeout;
+        for (auto &inverter : _inverters)
+            inverter.frame.setTimeout(timeout);
+    }
+
+    /// @brief Moves assembled data of the inverter into the site snapshot
+    void commit(int index)
+    {
+        Inverter &changed = _inverters[index];
+        if (!changed.contributes)
+        {
+            changed.contributes = true;
+            ++_contributing;
+        }
+
+        for (int f = 0; f < SolaxFields::count; ++f)
+        {
+            const int32_t previous = SolaxFields::at(changed.committed, f);
+            const int32_t current = SolaxFields::at(changed.data, f);
+
+            switch (SolaxFields::fields[f].aggregate)
+            {
+            case SolaxFields::Aggregate::Sum:
+                SolaxFields::at(_site, f) += current - previous;
+                break;
+            case SolaxFields::Aggregate::Average:
+                _sums[f] += static_cast<int64_t>(current) - previous;
+                SolaxFields::at(_site, f) = static_cast<int32_t>(_sums[f] / _contributing);
+                break;
+            case SolaxFields::Aggregate::Max:
+            case SolaxFields::Aggregate::First:
+                changed.committed.*(SolaxFields::fields[f].member) = current;
+                SolaxFields::at(_site, f) = combine(f);
+                break;
+            }
+        }
+
+        changed.committed = changed.data;
+    }
+
+    const SolaxParameters &site() const { return _site; }
+
+private:
+    // few inverters, non-additive fields are simply recomputed
+    int32_t combine(int field) const
+    {
+        bool first = true;
+        int32_t result = 0;
+        for (int i = 0; i < _count; ++i)
+        {
+            if (!_inverters[i].contributes)
+                continue;
+
+            const int32_t value = SolaxFields::at(_inverters[i].committed, field);
+            if (first)
+                result = value;
+            else if (SolaxFields::fields[field].aggregate == SolaxFields::Aggregate::Max && value > result)
+                result = value;
+            first = false;
+        }
+        return result;
+    }
+
+    std::array<Inverter, MaxInverters> _inverters{};
+    int _count{0};
+    int _contributing{0};
+    TickType_t _timeout{pdMS_TO_TICKS(FrameAssembler::DefaultTimeoutMs)};
+    std::array<int64_t, SolaxFields::count> _sums{}; // averaged fields
+    SolaxParameters _site{};
+};
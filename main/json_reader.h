@@ -0,0 +1,302 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2024 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   json_reader.h
+/// @author Petr Vanek
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+/// @brief Bounded, in-place JSON pull reader.
+///        Iterates one level of an object or array directly over the payload bytes,
+///        never allocates and never reads past the end of the view. Nested objects
+///        and arrays are returned as raw text and can be read by another JsonReader.
+class JsonReader
+{
+public:
+    enum class Type
+    {
+        Invalid,
+        Null,
+        Bool,
+        Number,
+        String,
+        Object,
+        Array
+    };
+
+    struct Value
+    {
+        Type type{Type::Invalid};
+        std::string_view text; // string content without quotes (escapes kept), raw number, raw object / array
+        int32_t number{0};     // Number truncated toward zero and saturated, Bool as 0 / 1
+    };
+
+    explicit JsonReader(std::string_view json) : _json(json) {}
+
+    /// @brief First significant character, '\0' at the end of the view
+    char peek()
+    {
+        skipWhitespace();
+        return _pos < _json.size() ? _json[_pos] : '\0';
+    }
+
+    /// @brief Enters the top level object
+    bool beginObject() { return begin('{'); }
+
+    /// @brief Enters the top level array
+    bool beginArray() { return begin('['); }
+
+    /// @brief Reads next member of the object
+    /// @return false at the end of the object or on malformed input (see failed())
+    bool nextMember(std::string_view &key, Value &value)
+    {
+        if (!nextItem('}'))
+            return false;
+
+        Value name;
+        if (!parseString(name) || !consume(':') || !parseValue(value))
+            return fail();
+
+        key = name.text;
+        return true;
+    }
+
+    /// @brief Reads next element of the array
+    /// @return false at the end of the array or on malformed input (see failed())
+    bool nextElement(Value &value)
+    {
+        if (!nextItem(']'))
+            return false;
+
+        if (!parseValue(value))
+            return fail();
+
+        return true;
+    }
+
+    bool failed() const { return _failed; }
+
+    /// @brief Only whitespace is left after the value that was read
+    bool atEnd()
+    {
+        skipWhitespace();
+        return _pos == _json.size();
+    }
+
+private:
+    static constexpr int MaxDepth = 16;
+
+    bool begin(char open)
+    {
+        _first = true;
+        if (!consume(open))
+            return fail();
+        return true;
+    }
+
+    bool nextItem(char close)
+    {
+        if (_failed)
+            return false;
+
+        if (peek() == close)
+        {
+            ++_pos;
+            return false;
+        }
+
+        if (!_first && !consume(','))
+            return fail();
+
+        _first = false;
+        return true;
+    }
+
+    bool fail()
+    {
+        _failed = true;
+        return false;
+    }
+
+    void skipWhitespace()
+    {
+        while (_pos < _json.size() && (_json[_pos] == ' ' || _json[_pos] == '\t' || _json[_pos] == '\n' || _json[_pos] == '\r'))
+            ++_pos;
+    }
+
+    bool consume(char c)
+    {
+        if (peek() != c)
+            return false;
+        ++_pos;
+        return true;
+    }
+
+    bool isDigit() const { return _pos < _json.size() && _json[_pos] >= '0' && _json[_pos] <= '9'; }
+
+    bool parseValue(Value &value)
+    {
+        value = Value{};
+        switch (peek())
+        {
+        case '"':
+            return parseString(value);
+        case '{':
+            value.type = Type::Object;
+            return skipNested(value);
+        case '[':
+            value.type = Type::Array;
+            return skipNested(value);
+        case 't':
+            value.number = 1;
+            return parseLiteral("true", Type::Bool, value);
+        case 'f':
+            value.number = 0;
+            return parseLiteral("false", Type::Bool, value);
+        case 'n':
+            value.number = 0;
+            return parseLiteral("null", Type::Null, value);
+        default:
+            return parseNumber(value);
+        }
+    }
+
+    bool parseLiteral(std::string_view literal, Type type, Value &value)
+    {
+        if (_json.substr(_pos, literal.size()) != literal)
+            return false;
+        value.type = type;
+        value.text = _json.substr(_pos, literal.size());
+        _pos += literal.size();
+        return true;
+    }
+
+    bool parseString(Value &value)
+    {
+        if (!consume('"'))
+            return false;
+
+        const size_t start = _pos;
+        while (_pos < _json.size() && _json[_pos] != '"')
+        {
+            _pos += (_json[_pos] == '\\') ? 2 : 1;
+        }
+
+        if (_pos >= _json.size())
+            return false;
+
+        value.type = Type::String;
+        value.text = _json.substr(start, _pos - start);
+        ++_pos; // closing quote
+        return true;
+    }
+
+    bool parseNumber(Value &value)
+    {
+        const size_t start = _pos;
+        const bool negative = (_pos < _json.size() && _json[_pos] == '-');
+        if (negative)
+            ++_pos;
+
+        int64_t mantissa = 0;
+        int exponent = 0;
+        int digits = 0;
+
+        for (; isDigit(); ++_pos, ++digits)
+        {
+            if (mantissa < 100000000000000000LL)
+                mantissa = mantissa * 10 + (_json[_pos] - '0');
+            else
+                ++exponent;
+        }
+
+        if (_pos < _json.size() && _json[_pos] == '.')
+        {
+            ++_pos;
+            for (; isDigit(); ++_pos)
+            {
+                if (mantissa < 100000000000000000LL)
+                {
+                    mantissa = mantissa * 10 + (_json[_pos] - '0');
+                    --exponent;
+                }
+            }
+        }
+
+        if (digits == 0)
+            return false;
+
+        if (_pos < _json.size() && (_json[_pos] == 'e' || _json[_pos] == 'E'))
+        {
+            ++_pos;
+            bool negativeExp = false;
+            if (_pos < _json.size() && (_json[_pos] == '+' || _json[_pos] == '-'))
+                negativeExp = (_json[_pos++] == '-');
+
+            int exp = 0;
+            if (!isDigit())
+                return false;
+            for (; isDigit(); ++_pos)
+            {
+                if (exp < 1000)
+                    exp = exp * 10 + (_json[_pos] - '0');
+            }
+            exponent += negativeExp ? -exp : exp;
+        }
+
+        // truncate toward zero like a cast from double, saturate to int32
+        for (; exponent < 0 && mantissa != 0; ++exponent)
+            mantissa /= 10;
+        for (; exponent > 0 && mantissa != 0 && mantissa <= INT32_MAX; --exponent)
+            mantissa *= 10;
+        if (mantissa > INT32_MAX)
+            mantissa = negative ? -static_cast<int64_t>(INT32_MIN) : INT32_MAX;
+
+        value.type = Type::Number;
+        value.text = _json.substr(start, _pos - start);
+        value.number = static_cast<int32_t>(negative ? -mantissa : mantissa);
+        return true;
+    }
+
+    bool skipNested(Value &value)
+    {
+        const size_t start = _pos;
+        int depth = 0;
+        while (_pos < _json.size())
+        {
+            const char c = _json[_pos];
+            if (c == '"')
+            {
+                Value ignored;
+                if (!parseString(ignored))
+                    return false;
+                continue;
+            }
+
+            ++_pos;
+            if (c == '{' || c == '[')
+            {
+                if (++depth > MaxDepth)
+                    return false;
+            }
+            else if (c == '}' || c == ']')
+            {
+                if (--depth == 0)
+                {
+                    value.text = _json.substr(start, _pos - start);
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    std::string_view _json;
+    size_t _pos{0};
+    bool _first{true};
+    bool _failed{false};
+};
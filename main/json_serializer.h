@@ -7,138 +7,143 @@
 
 #pragma once
 
-#include <string>
 #include <string_view>
-#include "cJSON.h"
+#include "esp_log.h"
+#include "json_reader.h"
 #include "mqtt_queue_data.h"
+#include "solax_fields.h"
 
 class JsonSerializer
 {
 public:
-    static void updateSolaxParameter(SolaxParameters &params, const std::string &key, int32_t value)
+    static bool updateSolaxParameter(SolaxParameters &params, std::string_view key, int32_t value)
     {
-        if (key == "PvVoltage1")
+        const int index = SolaxFields::find(key);
+        if (index == SolaxFields::NotFound)
         {
-            params.PvVoltage1 = value;
+            ESP_LOGW("SolaxParameters", "Unknown key: %.*s", static_cast<int>(key.size()), key.data());
+            return false;
         }
-        else if (key == "PvVoltage2")
-        {
-            params.PvVoltage2 = value;
-        }
-        else if (key == "PvCurrent1")
-        {
-            params.PvCurrent1 = value;
-        }
-        else if (key == "PvCurrent2")
-        {
-            params.PvCurrent2 = value;
-        }
-        else if (key == "Powerdc1")
-        {
-            params.Powerdc1 = value;
-        }
-        else if (key == "Powerdc2")
-        {
-            params.Powerdc2 = value;
-        }
-        else if (key == "BatVoltage_Charge1")
-        {
-            params.BatVoltage_Charge1 = value;
-        }
-        else if (key == "BatCurrent_Charge1")
-        {
-            params.BatCurrent_Charge1 = value;
-        }
-        else if (key == "Batpower_Charge1")
-        {
-            params.Batpower_Charge1 = value;
-        }
-        else if (key == "TemperatureBat")
-        {
-            params.TemperatureBat = value;
-        }
-        else if (key == "BattCap")
-        {
-            params.BattCap = value;
-        }
-        else if (key == "FeedinPower")
-        {
-            params.FeedinPower = value;
-        }
-        else if (key == "GridPower_R")
-        {
-            params.GridPower_R = value;
-        }
-        else if (key == "GridPower_S")
-        {
-            params.GridPower_S = value;
-        }
-        else if (key == "GridPower_T")
-        {
-            params.GridPower_T = value;
-        }
-        else if (key == "Etoday_togrid")
+
+        SolaxFields::at(params, index) = value;
+        return true;
+    }
+
+    /// @brief Updates parameters from one gateway message. Accepted forms are
+    ///        {"name":X,"value":Y}, a flat object {"PvVoltage1":Y,...} and an array
+    ///        of pairs [{"name":X,"value":Y},...] or [["PvVoltage1",Y],...].
+    ///        A message is applied as a whole, or not at all when it is malformed.
+    /// @return mask of updated fields (SolaxFields::bit)
+    static SolaxFields::Mask updateParametersFromJson(SolaxParameters &params, std::string_view jsonMessage)
+    {
+        if (jsonMessage.empty())
         {
-            params.Etoday_togrid = value;
+            ESP_LOGE("JSON", "EMPTY jsonMessage");
+            return 0;
         }
-        else if (key == "Temperature")
+
+        // read in place, the view points into the MQTT buffer and is not NUL terminated
+        SolaxParameters staged = params;
+        SolaxFields::Mask updated = 0;
+        bool ok = false;
+
+        JsonReader reader(jsonMessage);
+        if (reader.peek() == '[')
         {
-            params.Temperature = value;
+            ok = readPairArray(reader, staged, updated);
         }
-        else if (key == "RunMode")
+        else
         {
-            params.RunMode = value;
+            ok = readObject(reader, staged, updated, true);
         }
-        else if (key == "BDCStatus")
+
+        // nothing may follow the top level value
+        ok = ok && reader.atEnd();
+
+        if (!ok)
         {
-            params.BDCStatus = value;
+            ESP_LOGE("JSON", "Failed to parse JSON: %.*s", static_cast<int>(jsonMessage.size()), jsonMessage.data());
+            return 0;
         }
-        else if (key == "GridStatus")
+
+        if (!updated)
         {
-            params.GridStatus = value;
+            ESP_LOGW("JSON", "Invalid JSON structure");
+            return 0;
         }
-        else if (key == "MPPTCount")
+
+        params = staged;
+        return updated;
+    }
+
+private:
+    static void applyField(SolaxParameters &params, SolaxFields::Mask &updated, std::string_view key, int32_t value)
+    {
+        const int index = SolaxFields::find(key);
+        if (index != SolaxFields::NotFound)
         {
-            params.MPPTCount = value;
+            SolaxFields::at(params, index) = value;
+            updated |= SolaxFields::bit(index);
         }
-        else if (key == "HDO")
+    }
+
+    // {"name":X,"value":Y} or flat {"Field":Y,...}
+    static bool readObject(JsonReader &reader, SolaxParameters &params, SolaxFields::Mask &updated, bool flatAllowed)
+    {
+        std::string_view key;
+        JsonReader::Value item;
+        JsonReader::Value name;
+        JsonReader::Value value;
+
+        if (!reader.beginObject())
+            return false;
+
+        while (reader.nextMember(key, item))
         {
-            params.Hdo = value;
+            if (key == "name")
+                name = item;
+            else if (key == "value")
+                value = item;
+            else if (flatAllowed && item.type == JsonReader::Type::Number)
+                applyField(params, updated, key, item.number);
         }
-        else
+
+        if (value.type == JsonReader::Type::Number && name.type == JsonReader::Type::String)
         {
-            ESP_LOGW("SolaxParameters", "Unknown key: %s", key.c_str());
+            if (updateSolaxParameter(params, name.text, value.number))
+                updated |= SolaxFields::bit(SolaxFields::find(name.text));
         }
-    }
-    
 
-    static void updateParametersFromJson(SolaxParameters &params, std::string_view jsonMessage) {
-    if (jsonMessage.empty()) {
-        ESP_LOGE("JSON", "EMPTY jsonMessage");
-        return;
-    }
-    cJSON *json = cJSON_Parse(jsonMessage.data());
-    if (!json) {
-        ESP_LOGE("JSON", "Failed to parse JSON: %s", cJSON_GetErrorPtr());
-        return;
+        return !reader.failed();
     }
 
-    cJSON *value = cJSON_GetObjectItem(json, "value");
-    cJSON *name = cJSON_GetObjectItem(json, "name");
-
-    if (cJSON_IsNumber(value) && cJSON_IsString(name)) {
-        std::string nameStr = name->valuestring;
-        int32_t valueInt = static_cast<int32_t>(value->valuedouble); 
-
-        updateSolaxParameter(params, nameStr, valueInt);
-    } else {
-        ESP_LOGW("JSON", "Invalid JSON structure");
-    }
+    // [{"name":X,"value":Y},...] or [["Field",Y],...]
+    static bool readPairArray(JsonReader &reader, SolaxParameters &params, SolaxFields::Mask &updated)
+    {
+        JsonReader::Value element;
 
-    cJSON_Delete(json);
-}
+        if (!reader.beginArray())
+            return false;
 
+        while (reader.nextElement(element))
+        {
+            JsonReader pair(element.text);
+            if (element.type == JsonReader::Type::Object)
+            {
+                if (!readObject(pair, params, updated, false))
+                    return false;
+            }
+            else if (element.type == JsonReader::Type::Array)
+            {
+                JsonReader::Value name;
+                JsonReader::Value value;
+                if (!pair.beginArray() || !pair.nextElement(name) || !pair.nextElement(value))
+                    return false;
+                if (name.type == JsonReader::Type::String && value.type == JsonReader::Type::Number)
+                    applyField(params, updated, name.text, value.number);
+            }
+        }
 
+        return !reader.failed();
+    }
 };
-
-   
\ No newline at end of file
@@ -24,6 +24,7 @@ public:
     static constexpr const char *tsk_dspl{"DSPLTSK"};
     static constexpr const char *tsk_mqtt{"DSPLTSK"};
     static constexpr const char *tsk_time{"TIMETSK"};
+    static constexpr const char *tsk_ingest{"INGSTTSK"};
 
     // AP definition
     static constexpr const char *ap_name{"PVVIEWAP"};
@@ -43,6 +44,23 @@ public:
     static constexpr const char *kv_topic{"topic"};
     static constexpr const char *kv_timezone{"timezone"};
     static constexpr const char *kv_timeserver{"timeserver"};
+    static constexpr const char *kv_frame_timeout{"frametmo"};     // ms, partial MQTT frame is shown after
+    static constexpr const char *kv_metrics_topic{"mtopic"};       // derived metrics are published to, empty - disabled
+    static constexpr const char *kv_metrics_interval{"minterval"}; // s, one batch per interval
+    static constexpr const char *kv_def_metrics_topic{"pvview/metrics"};
+    static constexpr const char *kv_signal{"signal"};              // field:alpha:deadband:decimation;... (signal_conditioner.h)
+    static constexpr const char *kv_stale{"stale"};                // s, field without update is stale (greyed, not integrated)
+    static constexpr const char *kv_record{"record"};              // SD file name, raw MQTT traffic is recorded to
+    static constexpr const char *kv_replay{"replay"};              // SD file name replayed through the ingest path at start
+    static constexpr const char *kv_replay_speed{"replayx"};       // replay speed, N x real time, 0 - full speed
+    static constexpr const char *kv_frame_budget{"fbudget"};       // ms, display coalesces data within
+    static constexpr const char *kv_max_fps{"fpsmax"};             // display render rate cap
+    static constexpr const char *kv_lcd_lines{"lcdlines"};         // display buffer lines, overrides Kconfig
+    static constexpr const char *kv_lcd_double{"lcddouble"};       // 0/1 double display buffer
+    static constexpr const char *kv_lcd_psram{"lcdpsram"};         // 0/1 full frame display buffer in PSRAM
+    static constexpr const char *kv_lcd_transfer{"lcdxfer"};       // display lines per i80 transfer
+    static constexpr const char *kv_demo{"demo"};                  // ms per update of the scripted demo feed at start, 0 - off
+    static constexpr const char *kv_def_signal{"Batpower_Charge1:0.3:20:1;FeedinPower:0.3:20:1"};
     
     // spiffs filenames
     static constexpr const char *kv_fl_ap{"/spiffs/ap.html"};
@@ -0,0 +1,145 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2024 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   metrics_publisher.h
+/// @author Petr Vanek
+
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cinttypes>
+#include <cstdarg>
+#include <cstdio>
+#include <ctime>
+
+/// @brief Values derived on the device (DisplayTask), sent back to the broker
+struct DerivedMetrics
+{
+    int32_t consumption{0};   // W, house consumption
+    int32_t photovoltaic{0};  // W, DC power of all strings
+    int32_t freeEnergy{0};    // W, photovoltaic - consumption
+    int32_t inverterTotal{0}; // W, sum of the grid phases
+    int32_t hourlyValid{0};   // hourly arrays are filled (time is synchronized)
+    std::array<float, 24> hourlyConsumption{}; // Wh
+    std::array<float, 24> hourlyPhotovoltaic{}; // Wh
+};
+
+/// @brief Coalesces derived metrics into one JSON message, only the values
+///        that changed since the last batch are included.
+///        e.g. {"ts":1718000000,"cons":512,"free":1200,"cons_wh":[0,0,...]}
+class MetricsPublisher
+{
+public:
+    static constexpr int DefaultIntervalSec = 60;
+    static constexpr size_t MaxBatch = 512;
+
+    /// @brief Writes the batch into buffer
+    /// @param timestamp  unix time of the values, 0 - unknown (not included)
+    /// @return length of the message, 0 when nothing changed (or buffer too small)
+    size_t build(const DerivedMetrics &metrics, time_t timestamp, char *buffer, size_t size)
+    {
+        Writer writer{buffer, size};
+        writer.append("{");
+        if (timestamp)
+        {
+            writer.append("\"ts\":%lld,", static_cast<long long>(timestamp));
+        }
+
+        scalar(writer, "cons", metrics.consumption, _last.consumption);
+        scalar(writer, "pv", metrics.photovoltaic, _last.photovoltaic);
+        scalar(writer, "free", metrics.freeEnergy, _last.freeEnergy);
+        scalar(writer, "inv", metrics.inverterTotal, _last.inverterTotal);
+        if (metrics.hourlyValid)
+        {
+            hourly(writer, "cons_wh", metrics.hourlyConsumption, _lastConsumption);
+            hourly(writer, "pv_wh", metrics.hourlyPhotovoltaic, _lastPhotovoltaic);
+        }
+
+        writer.append("}");
+        if (writer.failed || writer.fields == 0)
+        {
+            return 0;
+        }
+
+        _valid = true;
+        _last = metrics;
+        _lastConsumption = rounded(metrics.hourlyConsumption);
+        _lastPhotovoltaic = rounded(metrics.hourlyPhotovoltaic);
+        return writer.length;
+    }
+
+    /// @brief Next batch contains every value (e.g. after reconnect)
+    void reset() { _valid = false; }
+
+private:
+    using Hourly = std::array<int32_t, 24>;
+
+    struct Writer
+    {
+        char *buffer;
+        size_t size;
+        size_t length{0};
+        int fields{0};
+        bool failed{false};
+
+        void append(const char *format, ...) __attribute__((format(printf, 2, 3)))
+        {
+            if (failed)
+            {
+                return;
+            }
+            va_list args;
+            va_start(args, format);
+            const int written = vsnprintf(buffer + length, size - length, format, args);
+            va_end(args);
+            if (written < 0 || static_cast<size_t>(written) >= size - length)
+            {
+                failed = true;
+                return;
+            }
+            length += written;
+        }
+    };
+
+    static Hourly rounded(const std::array<float, 24> &values)
+    {
+        Hourly result;
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            result[i] = static_cast<int32_t>(std::lround(values[i]));
+        }
+        return result;
+    }
+
+    void scalar(Writer &writer, const char *name, int32_t value, int32_t last)
+    {
+        if (_valid && value == last)
+        {
+            return;
+        }
+        writer.append("%s\"%s\":%" PRId32, writer.fields++ ? "," : "", name, value);
+    }
+
+    void hourly(Writer &writer, const char *name, const std::array<float, 24> &values, const Hourly &last)
+    {
+        const Hourly current = rounded(values);
+        if (_valid && current == last)
+        {
+            return;
+        }
+        writer.append("%s\"%s\":[", writer.fields++ ? "," : "", name);
+        for (size_t i = 0; i < current.size(); ++i)
+        {
+            writer.append("%s%" PRId32, i ? "," : "", current[i]);
+        }
+        writer.append("]");
+    }
+
+    bool _valid{false};
+    DerivedMetrics _last{};
+    Hourly _lastConsumption{};
+    Hourly _lastPhotovoltaic{};
+};
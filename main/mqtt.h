@@ -9,21 +9,31 @@
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
+#include <array>
 #include <functional>
 #include <esp_log.h>
 #include <mqtt_client.h>
 #include <string>
 #include <string_view>
-#include <map>
+#include <vector>
+#include "topic_trie.h"
 
 using MqttConnectedCallback = std::function<void()>;
 using MqttDisconnectedCallback = std::function<void()>;
 using MqttMessageCallback = std::function<void(std::string_view topic, std::string_view message)>;
+using MqttPublishedCallback = std::function<void(int msgId)>;
 
 class Mqtt
 {
 public:
     static constexpr const char *LOG_TAG = "Mqtt";
+    // Upper limit for a payload reassembled from several MQTT_EVENT_DATA chunks,
+    // with the topic it has to fit one IngestTask ring record (checked there)
+    static constexpr size_t MaxFragmentedPayload = 1920;
+    // Filters a single message can match (e.g. "solax/#" and "solax/+/data")
+    static constexpr size_t MaxMatchedFilters = 8;
+    // esp-mqtt retries the broker after this delay (default is 10 s)
+    static constexpr int ReconnectTimeoutMs = 1000;
 
     Mqtt()
         : _isConnected(false),
@@ -51,7 +61,10 @@ public:
         }
     }
 
-    bool init(std::string_view uri, std::string_view username = "", std::string_view password = "")
+    /// @brief Creates and starts the client. With a client ID the session is persistent
+    ///        (clean session off) - the broker keeps subscriptions and QoS 1 messages
+    ///        across reconnects; the client is meant to live across link flaps.
+    bool init(std::string_view uri, std::string_view username = "", std::string_view password = "", std::string_view clientId = "")
     {
         if (uri.empty())
         {
@@ -78,6 +91,9 @@ public:
             mqtt_cfg.broker.address.uri = uri.data();
             mqtt_cfg.credentials.username = username.empty() ? nullptr : username.data();
             mqtt_cfg.credentials.authentication.password = password.empty() ? nullptr : password.data();
+            mqtt_cfg.credentials.client_id = clientId.empty() ? nullptr : clientId.data();
+            mqtt_cfg.session.disable_clean_session = !clientId.empty();
+            mqtt_cfg.network.reconnect_timeout_ms = ReconnectTimeoutMs;
 
             _client = esp_mqtt_client_init(&mqtt_cfg);
             if (!_client)
@@ -88,13 +104,14 @@ public:
             }
 
             esp_mqtt_client_register_event(_client, MQTT_EVENT_ANY, &Mqtt::mqttEventHandler, this);
-            esp_err_t ret = esp_mqtt_client_start(_client);
-            _isConnected = (ret == ESP_OK);
-
-            ESP_LOGI(LOG_TAG, "MQTT %s", _isConnected ? "started successfully" : "failed to start");
+            _isConnected = false; // MQTT_EVENT_CONNECTED
             xSemaphoreGive(_connectionMutex);
 
-            return _isConnected;
+            // the event handler takes the mutex, esp-mqtt is started without it
+            esp_err_t ret = esp_mqtt_client_start(_client);
+            ESP_LOGI(LOG_TAG, "MQTT %s", ret == ESP_OK ? "started successfully" : "failed to start");
+
+            return ret == ESP_OK;
         }
         return false;
     }
@@ -109,6 +126,20 @@ public:
         _disconnectedCallback = callback;
     }
 
+    /// @brief Called from the esp-mqtt task when the broker acknowledged a QoS 1 message
+    void registerPublishedCallback(MqttPublishedCallback callback)
+    {
+        _publishedCallback = callback;
+    }
+
+    /// @brief Reconnects now instead of waiting for the reconnect timer (e.g. link is back)
+    bool reconnect()
+    {
+        // esp-mqtt calls are made outside _connectionMutex, the event handler
+        // takes the mutex while esp-mqtt holds its own lock
+        return _client && !isConnected() && esp_mqtt_client_reconnect(_client) == ESP_OK;
+    }
+
     bool isConnected() const
     {
         bool connected = false;
@@ -121,58 +152,73 @@ public:
     }
 
     bool publish(std::string_view topic, std::string_view data, int qos = 1, int retain = 0)
+    {
+        return publishId(topic, data, qos, retain) != -1;
+    }
+
+    /// @brief Publishes and returns the message id (0 for QoS 0), -1 on failure.
+    ///        For QoS 1 the published callback reports the PUBACK of the id.
+    int publishId(std::string_view topic, std::string_view data, int qos = 1, int retain = 0)
     {
         if (topic.empty() || data.empty())
         {
             ESP_LOGW(LOG_TAG, "topic / data is empty");
-            return false;
+            return -1;
         }
 
         if (!isConnected())
         {
             ESP_LOGW(LOG_TAG, "Cannot publish, MQTT is not connected");
-            return false;
+            return -1;
         }
 
-        int msg_id = esp_mqtt_client_publish(_client, topic.data(), data.data(), 0, qos, retain);
+        int msg_id = esp_mqtt_client_publish(_client, topic.data(), data.data(), static_cast<int>(data.size()), qos, retain);
         if (msg_id == -1)
         {
             ESP_LOGE(LOG_TAG, "Failed to publish message");
-            return false;
+            return -1;
         }
 
-        ESP_LOGI(LOG_TAG, "Published message with ID %d on topic %s", msg_id, topic.data());
-        return true;
+        ESP_LOGD(LOG_TAG, "Published message with ID %d on topic %s", msg_id, topic.data());
+        return msg_id;
     }
 
+    /// @brief Subscribes a topic filter, MQTT wildcards '+' and '#' are supported.
+    ///        The filter is kept in the routing table and subscribed again on every
+    ///        connect, so it can be registered before the broker is up.
     bool subscribe(const std::string &topic, MqttMessageCallback callback)
     {
-        if (topic.empty())
+        if (!TopicTrie<MqttMessageCallback>::isValidFilter(topic))
         {
-            ESP_LOGE(LOG_TAG, "Topic cannot be empty");
+            ESP_LOGE(LOG_TAG, "Invalid topic filter: %s", topic.c_str());
             return false;
         }
 
         if (xSemaphoreTake(_connectionMutex, portMAX_DELAY) == pdTRUE)
         {
-            if (!_isConnected)
+            if (!_client)
             {
-                ESP_LOGE(LOG_TAG, "MQTT is not connected");
+                ESP_LOGE(LOG_TAG, "MQTT is not initialized");
                 xSemaphoreGive(_connectionMutex);
                 return false;
             }
 
-            int msg_id = esp_mqtt_client_subscribe(_client, topic.c_str(), 1);
-            if (msg_id == -1)
+            _topicCallbacks.insert(topic, callback); // Register the callback
+            const bool connected = _isConnected;
+            xSemaphoreGive(_connectionMutex);
+
+            if (!connected)
             {
-                ESP_LOGE(LOG_TAG, "Failed to subscribe to topic: %s", topic.c_str());
-                xSemaphoreGive(_connectionMutex);
-                return false;
+                ESP_LOGI(LOG_TAG, "Topic %s queued until connect", topic.c_str());
+            }
+            else if (esp_mqtt_client_subscribe(_client, topic.c_str(), 1) == -1)
+            {
+                ESP_LOGW(LOG_TAG, "Failed to subscribe to topic: %s, retried on next connect", topic.c_str());
+            }
+            else
+            {
+                ESP_LOGI(LOG_TAG, "Subscribed to topic: %s", topic.c_str());
             }
-
-            _topicCallbacks[topic] = callback; // Register the callback
-            ESP_LOGI(LOG_TAG, "Subscribed to topic: %s", topic.c_str());
-            xSemaphoreGive(_connectionMutex);
             return true;
         }
         return false;
@@ -189,28 +235,26 @@ public:
         if (xSemaphoreTake(_connectionMutex, portMAX_DELAY) == pdTRUE)
         {
             // Check if the topic is registered
-            auto it = _topicCallbacks.find(topic);
-            if (it == _topicCallbacks.end())
+            if (!_topicCallbacks.contains(topic))
             {
                 ESP_LOGW(LOG_TAG, "Topic %s is not registered", topic.c_str());
                 xSemaphoreGive(_connectionMutex);
                 return false;
             }
 
+            // Remove the topic from the routing trie, also from the resubscribe list
+            _topicCallbacks.remove(topic);
+            xSemaphoreGive(_connectionMutex);
+
             // Unsubscribe from the topic
             int msg_id = esp_mqtt_client_unsubscribe(_client, topic.c_str());
             if (msg_id == -1)
             {
                 ESP_LOGE(LOG_TAG, "Failed to unsubscribe from topic: %s", topic.c_str());
-                xSemaphoreGive(_connectionMutex);
                 return false;
             }
 
-            // Remove the topic from the callback map
-            _topicCallbacks.erase(it);
-
             ESP_LOGI(LOG_TAG, "Unsubscribed from topic: %s", topic.c_str());
-            xSemaphoreGive(_connectionMutex);
             return true;
         }
         return false;
@@ -225,17 +269,25 @@ private:
         switch (event_id)
         {
         case MQTT_EVENT_CONNECTED:
-            ESP_LOGI(LOG_TAG, "MQTT Connected");
+        {
+            ESP_LOGI(LOG_TAG, "MQTT Connected, session %s", event->session_present ? "present" : "new");
+            std::vector<std::string> filters;
             if (xSemaphoreTake(client->_connectionMutex, portMAX_DELAY) == pdTRUE)
             {
                 client->_isConnected = true;
+                // a present session need not hold every filter (topic changed before
+                // a reboot, subscribed while offline) - SUBSCRIBE is idempotent
+                client->_topicCallbacks.forEach([&filters](std::string_view filter, const MqttMessageCallback &)
+                                                { filters.emplace_back(filter); });
                 xSemaphoreGive(client->_connectionMutex);
             }
+            client->resubscribe(filters);
             if (client->_connectedCallback)
             {
                 client->_connectedCallback();
             }
             break;
+        }
 
         case MQTT_EVENT_DISCONNECTED:
             ESP_LOGI(LOG_TAG, "MQTT Disconnected");
@@ -251,7 +303,11 @@ private:
             break;
 
         case MQTT_EVENT_PUBLISHED:
-            ESP_LOGI(LOG_TAG, "Message published successfully");
+            ESP_LOGD(LOG_TAG, "Message %d acknowledged", event->msg_id);
+            if (client->_publishedCallback)
+            {
+                client->_publishedCallback(event->msg_id);
+            }
             break;
 
         case MQTT_EVENT_ERROR:
@@ -259,22 +315,80 @@ private:
             break;
 
         case MQTT_EVENT_DATA:
+            client->onData(event);
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    // sends the routing table copied under _connectionMutex, esp-mqtt is called without it
+    void resubscribe(const std::vector<std::string> &filters)
+    {
+        for (const auto &filter : filters)
+        {
+            if (esp_mqtt_client_subscribe(_client, filter.c_str(), 1) == -1)
+                ESP_LOGE(LOG_TAG, "Failed to resubscribe topic: %s", filter.c_str());
+        }
+    }
+
+    void onData(esp_mqtt_event_handle_t event)
+    {
+        // views straight into the esp-mqtt buffer, valid only for this event
+        std::string_view topic(event->topic, event->topic_len);
+        std::string_view message(event->data, event->data_len);
+
+        if (event->total_data_len > event->data_len)
         {
-            std::string topic(event->topic, event->topic_len);
-            std::string message(event->data, event->data_len);
+            // fragmented payload - the topic is delivered with the first chunk only
+            if (event->current_data_offset == 0)
+            {
+                _fragmentTopic.assign(topic);
+                _fragmentBuffer.clear(); // keeps capacity, buffer is reused between messages
+                if (event->total_data_len > static_cast<int>(MaxFragmentedPayload))
+                {
+                    ESP_LOGW(LOG_TAG, "Fragmented message too large: %d", event->total_data_len);
+                    return;
+                }
+            }
 
-            // ESP_LOGI(LOG_TAG, "Received data on topic: %s", topic.c_str());
+            if (static_cast<size_t>(event->current_data_offset) != _fragmentBuffer.size() ||
+                _fragmentBuffer.size() + event->data_len > MaxFragmentedPayload)
+            {
+                return; // lost or oversized chunk, drop the rest of the message
+            }
 
-            auto it = client->_topicCallbacks.find(topic);
-            if (it != client->_topicCallbacks.end() && it->second)
+            _fragmentBuffer.insert(_fragmentBuffer.end(), event->data, event->data + event->data_len);
+            if (_fragmentBuffer.size() < static_cast<size_t>(event->total_data_len))
             {
-                it->second(topic, message); // Invoke the callback
+                return; // wait for the next chunk
             }
-            break;
+
+            topic = _fragmentTopic;
+            message = std::string_view(_fragmentBuffer.data(), _fragmentBuffer.size());
         }
 
-        default:
-            break;
+        // ESP_LOGI(LOG_TAG, "Received data on topic: %.*s", static_cast<int>(topic.size()), topic.data());
+
+        // every matching filter, e.g. "solax/+/data" fans out to one handler per source;
+        // subscribe() / unsubscribe() change the trie from other tasks, so the callbacks
+        // are copied under the lock and invoked without it
+        size_t matched = 0;
+        if (xSemaphoreTake(_connectionMutex, portMAX_DELAY) == pdTRUE)
+        {
+            _topicCallbacks.match(topic, [&](const MqttMessageCallback &callback)
+                                  {
+                                      if (callback && matched < _matched.size())
+                                          _matched[matched++] = callback;
+                                  });
+            xSemaphoreGive(_connectionMutex);
+        }
+
+        for (size_t i = 0; i < matched; ++i)
+        {
+            _matched[i](topic, message); // Invoke the callback
+            _matched[i] = nullptr;
         }
     }
 
@@ -283,5 +397,9 @@ private:
     SemaphoreHandle_t _connectionMutex;
     MqttConnectedCallback _connectedCallback{};
     MqttDisconnectedCallback _disconnectedCallback{};
-    std::map<std::string, MqttMessageCallback> _topicCallbacks;
+    MqttPublishedCallback _publishedCallback{};
+    TopicTrie<MqttMessageCallback> _topicCallbacks; // filter -> callback
+    std::array<MqttMessageCallback, MaxMatchedFilters> _matched{}; // onData, esp-mqtt task only
+    std::string _fragmentTopic;
+    std::vector<char> _fragmentBuffer;
 };
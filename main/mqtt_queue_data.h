@@ -8,6 +8,7 @@
 #pragma once
 
 #include <ctype.h>
+#include <cstdint>
 
 
 
@@ -0,0 +1,175 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2024 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   mqtt_recording.h
+/// @author Petr Vanek
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "esp_log.h"
+
+/// @brief Raw MQTT traffic stored in a file, for replay through the ingest path.
+///
+///        file:   "PVRC" | uint32 version | record ...
+///        record: uint32 time ms (from the first record) | uint16 topic length |
+///                uint16 payload length | topic | payload        (little endian)
+class MqttRecording
+{
+public:
+    static constexpr uint32_t Version = 1;
+    static constexpr size_t MaxPayload = 4096;
+
+    struct Record
+    {
+        uint32_t timeMs{0};
+        std::string_view topic;
+        std::string_view payload;
+    };
+
+    MqttRecording() = default;
+    MqttRecording(const MqttRecording &) = delete;
+    MqttRecording &operator=(const MqttRecording &) = delete;
+
+    ~MqttRecording()
+    {
+        close();
+    }
+
+    /// @brief New recording, an existing file is overwritten
+    bool create(const std::string &path)
+    {
+        close();
+        _file = fopen(path.c_str(), "wb");
+        if (!_file)
+        {
+            ESP_LOGE(TAG, "Failed to create recording: %s", path.c_str());
+            return false;
+        }
+
+        const uint32_t header[] = {Magic, Version};
+        if (fwrite(header, sizeof(header), 1, _file) != 1)
+        {
+            close();
+            return false;
+        }
+        _writing = true;
+        return true;
+    }
+
+    /// @brief Existing recording for next()
+    bool open(const std::string &path)
+    {
+        close();
+        _file = fopen(path.c_str(), "rb");
+        uint32_t header[2] = {};
+        if (!_file || fread(header, sizeof(header), 1, _file) != 1 || header[0] != Magic || header[1] != Version)
+        {
+            ESP_LOGE(TAG, "Not a recording: %s", path.c_str());
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close()
+    {
+        if (_file)
+        {
+            fclose(_file);
+            _file = nullptr;
+        }
+        _writing = false;
+        _count = 0;
+        _start = 0;
+    }
+
+    /// @brief Writes buffered records to the file
+    void flush()
+    {
+        if (_file && _writing)
+        {
+            fflush(_file);
+        }
+    }
+
+    bool isOpen() const { return _file != nullptr; }
+    uint32_t count() const { return _count; }
+
+    /// @brief Appends one message
+    /// @param nowMs any monotonic ms clock, stored relative to the first record
+    bool append(uint32_t nowMs, std::string_view topic, std::string_view payload)
+    {
+        if (!_file || !_writing || topic.size() > UINT16_MAX || payload.size() > MaxPayload)
+        {
+            return false;
+        }
+
+        if (_count == 0)
+        {
+            _start = nowMs;
+        }
+
+        RecordHeader header{nowMs - _start, static_cast<uint16_t>(topic.size()), static_cast<uint16_t>(payload.size())};
+        if (fwrite(&header, sizeof(header), 1, _file) != 1 ||
+            fwrite(topic.data(), 1, topic.size(), _file) != topic.size() ||
+            fwrite(payload.data(), 1, payload.size(), _file) != payload.size())
+        {
+            ESP_LOGE(TAG, "Recording write failed");
+            return false;
+        }
+        ++_count;
+        return true;
+    }
+
+    /// @brief Next message, the views stay valid until the next call
+    bool next(Record &record)
+    {
+        if (!_file || _writing)
+        {
+            return false;
+        }
+
+        RecordHeader header;
+        if (fread(&header, sizeof(header), 1, _file) != 1 || header.payloadLength > MaxPayload)
+        {
+            return false;
+        }
+
+        _buffer.resize(header.topicLength + header.payloadLength);
+        if (fread(_buffer.data(), 1, _buffer.size(), _file) != _buffer.size())
+        {
+            return false;
+        }
+
+        record.timeMs = header.timeMs;
+        record.topic = std::string_view(_buffer.data(), header.topicLength);
+        record.payload = std::string_view(_buffer.data() + header.topicLength, header.payloadLength);
+        ++_count;
+        return true;
+    }
+
+private:
+    static constexpr const char *TAG = "MqttRecording";
+    static constexpr uint32_t Magic = 0x43525650; // "PVRC"
+
+    struct RecordHeader
+    {
+        uint32_t timeMs;
+        uint16_t topicLength;
+        uint16_t payloadLength;
+    };
+    static_assert(sizeof(RecordHeader) == 8, "packed record header expected");
+
+    FILE *_file{nullptr};
+    std::vector<char> _buffer; // reused by next()
+    uint32_t _count{0};
+    uint32_t _start{0};
+    bool _writing{false};
+};
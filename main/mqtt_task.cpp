@@ -6,6 +6,8 @@
 /// @author Petr Vanek
 
 #include <cstdint>
+#include <cinttypes>
+#include <ctime>
 #include <atomic>
 #include <stdio.h>
 #include <memory.h>
@@ -16,8 +18,9 @@
 #include "mqtt_task.h"
 #include "literals.h"
 #include "application.h"
-#include "json_serializer.h"
 #include "key_val.h"
+#include "esp_timer.h"
+#include "esp_mac.h"
 
 MqttTask::MqttTask() : _mqttClient(nullptr), _mqttInitialized(false)
 {
@@ -37,7 +40,7 @@ MqttTask::~MqttTask()
     done();
 }
 
-void MqttTask::initializeMqttClient()
+bool MqttTask::initializeMqttClient()
 {
 
     KeyVal &kv = KeyVal::getInstance();
@@ -57,16 +60,31 @@ void MqttTask::initializeMqttClient()
             ESP_LOGI(LOG_TAG, "Disconnected from MQTT broker");
              if (_connectionManager) _connectionManager->setMqttDeactive(); 
              Application::getInstance()->getDisplayTask()->settingMsg("Disconnected from MQTT broker"); });
+        // PUBACKs of the drained outbox records, applied by drainOutbox()
+        _mqttClient->registerPublishedCallback([this](int msgId)
+                                               {
+                                                   std::lock_guard<std::mutex> lock(_ackMutex);
+                                                   if (_ackCount < _acks.size())
+                                                       _acks[_ackCount++] = msgId; });
 
         std::string mqtt;
         mqtt = "mqtt://";
         mqtt += kv.readString(literals::kv_mqtt);
-        if (!_mqttClient->init(mqtt, kv.readString(literals::kv_user), kv.readString(literals::kv_passwd)))
+        // stable client ID - the broker keeps our session across link flaps
+        uint8_t mac[6] = {};
+        esp_read_mac(mac, ESP_MAC_WIFI_STA);
+        char clientId[24];
+        snprintf(clientId, sizeof(clientId), "pvview-%02x%02x%02x%02x%02x%02x", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+
+        if (!_mqttClient->init(mqtt, kv.readString(literals::kv_user), kv.readString(literals::kv_passwd), clientId))
         {
             ESP_LOGE(LOG_TAG, "Failed to initialize MQTT client");
             Application::getInstance()->getDisplayTask()->settingMsg("Failed to initialize MQTT client");
+            doneMqttClient();
+            return false;
         }
     }
+    return true;
 }
 
 void MqttTask::doneMqttClient()
@@ -78,62 +96,187 @@ void MqttTask::doneMqttClient()
     }
 }
 
+void MqttTask::publishMetrics()
+{
+    const auto now = xTaskGetTickCount();
+    if (_metricsTopic.empty() || now - _metricsLast < _metricsInterval)
+    {
+        return;
+    }
+
+    _metricsLast = now;
+    DerivedMetrics metrics;
+    if (!Application::getInstance()->getDisplayTask()->fetchMetrics(metrics))
+    {
+        return;
+    }
+
+    const bool online = _mqttClient && _connectionManager && _connectionManager->isMqttActive();
+    const time_t timestamp = (_connectionManager && _connectionManager->isTimeActive()) ? time(nullptr) : 0;
+
+    if (online)
+    {
+        auto length = _metricsPublisher.build(metrics, timestamp, _batch.data(), _batch.size());
+        if (!length || _mqttClient->publish(_metricsTopic, std::string_view(_batch.data(), length), 0))
+        {
+            return;
+        }
+    }
+
+    // offline - every stored record carries all values
+    if (!_outbox.isOpen())
+    {
+        _outbox.open(Application::getInstance()->getDisplayTask()->isSdCardMounted() ? OutboxPath : "");
+    }
+    _metricsPublisher.reset();
+    auto length = _metricsPublisher.build(metrics, timestamp, _batch.data(), _batch.size());
+    _metricsPublisher.reset();
+    if (length && !_outbox.push(std::string_view(_batch.data(), length)))
+    {
+        ESP_LOGW(LOG_TAG, "Outbox write failed");
+    }
+}
+
+void MqttTask::drainOutbox()
+{
+    if (!_outbox.isOpen() || _outbox.empty() || !_mqttClient)
+    {
+        return;
+    }
+
+    // a record is removed by its PUBACK only, the outbox file is touched by this task only
+    const TickType_t now = xTaskGetTickCount();
+    std::array<int, AckQueue> acks;
+    size_t ackCount;
+    {
+        std::lock_guard<std::mutex> lock(_ackMutex);
+        acks = _acks;
+        ackCount = _ackCount;
+        _ackCount = 0;
+    }
+    for (size_t i = 0; i < ackCount; ++i)
+    {
+        if (_outbox.acknowledge(acks[i]))
+            _drainProgress = now;
+    }
+
+    // esp-mqtt retransmits unacknowledged QoS 1 messages itself, a message it gave up
+    // on (outbox expiry) is sent again from our outbox
+    if (_outbox.inFlight() && now - _drainProgress > AckTimeout)
+    {
+        ESP_LOGW(LOG_TAG, "No PUBACK in time, %" PRIu32 " outbox records sent again", _outbox.inFlight());
+        _outbox.resend();
+    }
+
+    // a failed publish (broker gone again) keeps the record
+    const bool idle = _outbox.inFlight() == 0;
+    if (_outbox.drain(MaxDrainPerCycle, [this](std::string_view record)
+                      { return _mqttClient->publishId(_metricsTopic, record, 1); }) &&
+        idle)
+    {
+        _drainProgress = now;
+    }
+
+    if (_outbox.empty())
+    {
+        ESP_LOGI(LOG_TAG, "Outbox drained, %" PRIu32 " records lost while full", _outbox.dropped());
+    }
+}
+
+TickType_t MqttTask::nextWork() const
+{
+    if (_metricsTopic.empty())
+    {
+        return portMAX_DELAY;
+    }
+
+    if (_outbox.isOpen() && !_outbox.empty() && _connectionManager && _connectionManager->isMqttActive())
+    {
+        return DrainPeriod;
+    }
+
+    const auto elapsed = xTaskGetTickCount() - _metricsLast;
+    return elapsed >= _metricsInterval ? 1 : _metricsInterval - elapsed;
+}
+
 void MqttTask::loop()
 {
     KeyVal &kv = KeyVal::getInstance();
     auto topic = kv.readString(literals::kv_topic, "solax/data");
     Application::getInstance()->signalTaskStart(Application::TaskBit::Mqtt);
-    bool subscribe = false;
-    uint16_t counter = 0;  
-    std::memset(&_solaxData, 0, sizeof(SolaxParameters));
-    Application::getInstance()->getDisplayTask()->updateUI(_solaxData);
+    bool linkUp = false;
+    _metricsTopic = kv.readString(literals::kv_metrics_topic, literals::kv_def_metrics_topic);
+    _metricsInterval = pdMS_TO_TICKS(1000 * kv.readUint32(literals::kv_metrics_interval, MetricsPublisher::DefaultIntervalSec));
+
+    // DisplayTask mounts the card before it signals its start; records stored
+    // before a reset are sent as soon as the broker is up
+    Application::getInstance()->waitForAllTasks({Application::TaskBit::Display});
+    if (!_metricsTopic.empty() && Application::getInstance()->getDisplayTask()->isSdCardMounted())
+    {
+        _outbox.open(OutboxPath);
+    }
+
     while (true)
     { // Loop forever
 
-        // Check connection status
-        if (_connectionManager && _connectionManager->isConnected())
+        // one client for the whole run, esp-mqtt reconnects it after a link flap
+        const bool connected = _connectionManager && _connectionManager->isConnected();
+        if (connected && !linkUp)
         {
+            linkUp = true;
+            _firstMessage = true;
             if (!_mqttInitialized)
             {
-                initializeMqttClient(); // Initialize MQTT only once upon connection
-                _mqttInitialized = true;
+                _mqttInitialized = initializeMqttClient();
+                if (_mqttInitialized)
+                {
+                    ESP_LOGI(LOG_TAG, "Topic registration [%s]", topic.c_str());
+                    // runs in the esp-mqtt client task - only copy, parsing is done by IngestTask
+                    _mqttClient->subscribe(topic, [this](std::string_view topic, std::string_view message)
+                                           {
+                                               if (_firstMessage.exchange(false) && _connectionManager)
+                                               {
+                                                   ESP_LOGI(LOG_TAG, "First message %" PRId64 " ms after IP",
+                                                            (esp_timer_get_time() - _connectionManager->connectedAt()) / 1000);
+                                               }
+                                               Application::getInstance()->getIngestTask()->push(topic, message); });
+                }
             }
-        }
-        else
-        {
-            // Connection lost
-            if (_mqttInitialized)
+            else if (_mqttClient->reconnect())
             {
-                // Clean up the MQTT client if it was previously initialized
-                doneMqttClient();
+                ESP_LOGI(LOG_TAG, "Link is back, reconnecting to the broker");
             }
-            _mqttInitialized = false;
         }
-
-        if (_connectionManager && _connectionManager->isMqttActive() && !subscribe)
+        else if (!connected && linkUp)
         {
-            ESP_LOGI(LOG_TAG, "Topic registration [%s]", topic.c_str());
-            subscribe = true;
-            _mqttClient->subscribe(topic, [this, &counter](std::string_view topic, std::string_view message) { 
-                JsonSerializer::updateParametersFromJson(_solaxData, message);
-                counter++;
-
-                // number of necessary data received for GUI update
-                if (counter > 20) {
-                    counter = 0; 
-                    Application::getInstance()->getDisplayTask()->updateUI(_solaxData);
-                }
-                });
+            linkUp = false;
+            ESP_LOGI(LOG_TAG, "Link lost, MQTT session is kept");
         }
 
-        if (_connectionManager && !_connectionManager->isMqttActive() && subscribe)
+        publishMetrics();
+        if (_connectionManager && _connectionManager->isMqttActive())
+        {
+            drainOutbox();
+        }
+        else
         {
-            //ESP_LOGI(LOG_TAG, "Topic remove [%s]", topic.c_str());
-            //_mqttClient->unsubscribe(topic);
-            //subscribe = false;
+            _metricsPublisher.reset();
         }
 
+        if (!_connectionManager)
+        {
+            vTaskDelay(DrainPeriod);
+            continue;
+        }
 
-        vTaskDelay(1000 / portTICK_PERIOD_MS);
+        // sleep until the link / broker state changes or periodic work is due,
+        // the bits are levels - a change since the checks above returns at once
+        EventBits_t edges = ConnectionManager::WIFI_CONNECTED_BIT;
+        if (linkUp)
+        {
+            edges = ConnectionManager::WIFI_DISCONNECTED_BIT |
+                    (_connectionManager->isMqttActive() ? ConnectionManager::MQTT_DISCONNECTED_BIT : ConnectionManager::MQTT_CONNECTED_BIT);
+        }
+        _connectionManager->waitAny(edges, nextWork());
     }
 }
@@ -7,15 +7,19 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <memory>
+#include <mutex>
 
 #include "hardware.h"
 #include "rptask.h"
 #include "mqtt.h"
 #include "literals.h"
 #include "connection_manager.h"
-#include  "mqtt_queue_data.h"
 #include "mqtt_queue_data.h"
+#include "metrics_publisher.h"
+#include "outbox.h"
 
 class MqttTask : public RPTask
 {
@@ -26,16 +30,34 @@ public:
 
 protected:
 	void loop() override;
-	void initializeMqttClient();
+	bool initializeMqttClient();
 	void doneMqttClient();
+	void publishMetrics();
+	void drainOutbox();
+	TickType_t nextWork() const;
 
 private:
 	static constexpr const char *LOG_TAG = "MqttTask";
+	static constexpr int MaxDrainPerCycle = 2; // backlog records in flight (QoS 1), live data goes first
+	static constexpr TickType_t AckTimeout = pdMS_TO_TICKS(10000); // outbox record without PUBACK is sent again
+	static constexpr size_t AckQueue = 2 * Outbox::MaxInFlight;  // PUBACKs between two drains, also of resent ids
+	static constexpr TickType_t DrainPeriod = pdMS_TO_TICKS(1000);
+	static constexpr const char *OutboxPath = "/sdcard/outbox.bin";
 	std::shared_ptr<ConnectionManager> _connectionManager;
 	// Unique pointer to the MQTT client object
     std::unique_ptr<Mqtt> _mqttClient {};
     // Boolean flag to track if the client is connected
 	 bool _mqttInitialized{false};
-	 SolaxParameters _solaxData;
+	 MetricsPublisher _metricsPublisher; // derived values back to the broker
+	 std::string _metricsTopic;
+	 TickType_t _metricsInterval{0};
+	 TickType_t _metricsLast{0};
+	 Outbox _outbox; // metrics produced while the broker is offline
+	 std::array<char, MetricsPublisher::MaxBatch> _batch{}; // publishMetrics(), off the task stack
+	 std::mutex _ackMutex; // _acks is filled by the esp-mqtt task
+	 std::array<int, AckQueue> _acks{};
+	 size_t _ackCount{0};
+	 TickType_t _drainProgress{0}; // last PUBACK or start of a drain window
+	 std::atomic<bool> _firstMessage{false}; // latency IP -> first message
 
 };
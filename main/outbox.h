@@ -0,0 +1,291 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2024 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   outbox.h
+/// @author Petr Vanek
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "esp_log.h"
+
+/// @brief Bounded store-and-forward queue of outgoing messages. Records live in
+///        a ring file of fixed slots (survives a reset) or in RAM when there is
+///        no card. When full, the oldest record is overwritten.
+///
+///        file: Header | slot 0 | slot 1 | ... , slot = uint16 length + data
+class Outbox
+{
+public:
+    static constexpr size_t SlotSize = 512;
+    static constexpr size_t MaxRecord = SlotSize - sizeof(uint16_t);
+    static constexpr uint32_t FileSlots = 256; // 128 kB on the card
+    static constexpr uint32_t RamSlots = 8;
+    static constexpr uint32_t MaxInFlight = 4; // drain window, records waiting for PUBACK
+
+    Outbox() = default;
+    Outbox(const Outbox &) = delete;
+    Outbox &operator=(const Outbox &) = delete;
+
+    ~Outbox()
+    {
+        close();
+    }
+
+    /// @brief Opens (or creates) the ring file, empty path - RAM only
+    bool open(const std::string &path)
+    {
+        close();
+        _opened = true;
+        if (!path.empty() && openFile(path))
+        {
+            ESP_LOGI(TAG, "Outbox file %s, %" PRIu32 " records pending", path.c_str(), size());
+            return true;
+        }
+
+        _header = Header{Magic, RamSlots, 0, 0};
+        _ram.assign(RamSlots * SlotSize, 0);
+        ESP_LOGW(TAG, "Outbox in RAM, %" PRIu32 " records", RamSlots);
+        return false;
+    }
+
+    void close()
+    {
+        _inFlight = 0;
+        if (_file)
+        {
+            fclose(_file);
+            _file = nullptr;
+        }
+        _ram.clear();
+        _ram.shrink_to_fit();
+        _opened = false;
+    }
+
+    bool isOpen() const { return _opened; }
+    bool persistent() const { return _file != nullptr; }
+    uint32_t size() const { return _header.head - _header.tail; }
+    bool empty() const { return size() == 0; }
+    uint32_t dropped() const { return _dropped; }
+
+    /// @brief Appends a record, the oldest one is lost when the outbox is full
+    bool push(std::string_view data)
+    {
+        if (!_opened || data.empty() || data.size() > MaxRecord)
+        {
+            return false;
+        }
+
+        if (size() >= _header.slots)
+        {
+            ++_header.tail;
+            ++_dropped;
+            if (_inFlight)
+            {
+                shiftPending(1); // its PUBACK is ignored
+            }
+        }
+
+        const uint16_t length = static_cast<uint16_t>(data.size());
+        std::memcpy(_slot.data(), &length, sizeof(length));
+        std::memcpy(_slot.data() + sizeof(length), data.data(), data.size());
+        if (!writeSlot(_header.head % _header.slots, _slot.data(), sizeof(length) + data.size()))
+        {
+            return false;
+        }
+
+        ++_header.head;
+        return writeHeader();
+    }
+
+    /// @brief Sends the oldest records not sent yet, at most window of them wait for
+    ///        the broker. publish(std::string_view) returns the message id (QoS 1) or
+    ///        -1; a record is removed only by acknowledge() of its id, so records are
+    ///        not lost when the link drops between publish and PUBACK
+    /// @return number of records sent
+    template <typename Publish>
+    uint32_t drain(uint32_t window, Publish &&publish)
+    {
+        uint32_t sent = 0;
+        window = std::min(window, MaxInFlight);
+        while (_inFlight < window && _inFlight < size())
+        {
+            const int length = readRecord(_header.tail + _inFlight);
+            if (length < 0)
+            {
+                break; // read error, retried next time
+            }
+            if (length == 0)
+            {
+                _pending[_inFlight++] = Acknowledged; // damaged slot, released with the others
+                continue;
+            }
+
+            const int id = publish(std::string_view(_record.data(), length));
+            if (id <= 0)
+            {
+                break;
+            }
+            _pending[_inFlight++] = id;
+            ++sent;
+        }
+        release();
+        return sent;
+    }
+
+    /// @brief PUBACK of a drained record, the acknowledged oldest records are removed
+    /// @return false when the id is not one of the records in flight
+    bool acknowledge(int msgId)
+    {
+        for (uint32_t i = 0; i < _inFlight; ++i)
+        {
+            if (_pending[i] == msgId)
+            {
+                _pending[i] = Acknowledged;
+                release();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// @brief Connection lost or no PUBACK in time - the records in flight are sent
+    ///        again by the next drain (at least once, the broker may see a duplicate)
+    void resend() { _inFlight = 0; }
+
+    /// @brief Records sent and waiting for PUBACK
+    uint32_t inFlight() const { return _inFlight; }
+
+private:
+    static constexpr const char *TAG = "Outbox";
+    static constexpr uint32_t Magic = 0x3142584F; // "OXB1"
+    static constexpr int Acknowledged = 0;        // QoS 1 message ids are positive
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t slots;
+        uint32_t head; // records written
+        uint32_t tail; // records released
+    };
+
+    bool openFile(const std::string &path)
+    {
+        _file = fopen(path.c_str(), "r+b");
+        if (_file && fread(&_header, sizeof(_header), 1, _file) == 1 && _header.magic == Magic &&
+            _header.slots == FileSlots && _header.head - _header.tail <= FileSlots)
+        {
+            return true;
+        }
+
+        // new or not compatible - start empty
+        if (_file)
+        {
+            fclose(_file);
+        }
+        _file = fopen(path.c_str(), "w+b");
+        _header = Header{Magic, FileSlots, 0, 0};
+        if (_file && writeHeader())
+        {
+            return true;
+        }
+
+        ESP_LOGE(TAG, "Failed to create outbox file: %s", path.c_str());
+        if (_file)
+        {
+            fclose(_file);
+            _file = nullptr;
+        }
+        return false;
+    }
+
+    bool writeHeader()
+    {
+        if (!_file)
+        {
+            return true;
+        }
+        return fseek(_file, 0, SEEK_SET) == 0 && fwrite(&_header, sizeof(_header), 1, _file) == 1 && fflush(_file) == 0;
+    }
+
+    bool writeSlot(uint32_t index, const uint8_t *data, size_t length)
+    {
+        if (!_file)
+        {
+            std::memcpy(_ram.data() + index * SlotSize, data, length);
+            return true;
+        }
+        return fseek(_file, sizeof(Header) + index * SlotSize, SEEK_SET) == 0 && fwrite(data, 1, length, _file) == length;
+    }
+
+    // record at the given position into _record
+    // @return length, 0 for a damaged slot, -1 on a read error
+    int readRecord(uint32_t position)
+    {
+        if (!readSlot(position % _header.slots, _slot.data()))
+        {
+            return -1;
+        }
+
+        uint16_t length;
+        std::memcpy(&length, _slot.data(), sizeof(length));
+        if (length == 0 || length > MaxRecord)
+        {
+            return 0;
+        }
+        std::memcpy(_record.data(), _slot.data() + sizeof(length), length);
+        return length;
+    }
+
+    // removes the acknowledged records at the tail
+    void release()
+    {
+        uint32_t count = 0;
+        while (count < _inFlight && _pending[count] == Acknowledged)
+        {
+            ++count;
+        }
+        if (count)
+        {
+            _header.tail += count;
+            shiftPending(count);
+            writeHeader();
+        }
+    }
+
+    void shiftPending(uint32_t count)
+    {
+        std::copy(_pending.begin() + count, _pending.begin() + _inFlight, _pending.begin());
+        _inFlight -= count;
+    }
+
+    bool readSlot(uint32_t index, uint8_t *data)
+    {
+        if (!_file)
+        {
+            std::memcpy(data, _ram.data() + index * SlotSize, SlotSize);
+            return true;
+        }
+        std::memset(data, 0, SlotSize);
+        return fseek(_file, sizeof(Header) + index * SlotSize, SEEK_SET) == 0 && fread(data, 1, SlotSize, _file) > 0;
+    }
+
+    FILE *_file{nullptr};
+    std::array<uint8_t, SlotSize> _slot{};  // one slot of file I/O, kept off the task stack
+    std::array<char, MaxRecord> _record{};  // drain()
+    std::array<int, MaxInFlight> _pending{}; // message ids of the records in flight, from the tail
+    uint32_t _inFlight{0};
+    std::vector<uint8_t> _ram;
+    Header _header{Magic, RamSlots, 0, 0};
+    uint32_t _dropped{0};
+    bool _opened{false};
+};
@@ -5,7 +5,13 @@
 /// @file   shoelace.h  Shoelace formula
 /// @author Petr Vanek
 
+#pragma once
+
 #include <array>
+#include <functional>
+#include <numeric>
+#include <sstream>
+#include <string>
 #include <time.h>
 #include <stdio.h>
 #include "esp_log.h"
@@ -38,7 +44,12 @@ public:
 
     void update(float currentPower) 
     {
-        time_t now = time(NULL); 
+        update(currentPower, time(NULL));
+    }
+
+    // explicit clock, e.g. the timestamps of a recording
+    void update(float currentPower, time_t now)
+    {
         struct tm currentTime;
         localtime_r(&now, &currentTime); 
 
@@ -57,6 +68,12 @@ public:
         lastUpdateTime = now;
     }
 
+    // input is not valid (stale) - the gap is not integrated, next update starts again
+    void pause()
+    {
+        lastUpdateTime = 0;
+    }
+
     void resetDailyConsumption()
     {
         hourlyConsumption.fill(0); 
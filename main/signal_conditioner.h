@@ -0,0 +1,166 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2024 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   signal_conditioner.h
+/// @author Petr Vanek
+
+#pragma once
+
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <string_view>
+#include "esp_log.h"
+#include "solax_fields.h"
+
+/// @brief Per-field conditioning of gateway values before they reach the UI:
+///        EMA smoothing, deadband and decimation. Fixed memory, O(1) per field.
+///        A field is reported as changed only when its output moved by at least
+///        the deadband. The raw snapshot travels with the frame, energy
+///        accounting never sees the conditioned values.
+///
+///        Configuration "name:alpha:deadband:decimation;..." e.g.
+///        "Batpower_Charge1:0.3:20:1;FeedinPower:0.3:20:1"
+///        alpha 0..1 (1 - no smoothing), deadband in field units,
+///        decimation - output is evaluated every N-th sample only.
+///        Fields not listed pass through unchanged.
+class SignalConditioner
+{
+public:
+    static constexpr int32_t AlphaOne = 256; // Q8 fixed point
+
+    struct Config
+    {
+        int32_t alpha{AlphaOne};
+        int32_t deadband{0};
+        uint16_t decimation{1};
+    };
+
+    /// @brief Parses the configuration string, invalid entries are skipped
+    /// @return number of configured fields
+    int configure(std::string_view config)
+    {
+        _config.fill(Config{});
+        int configured = 0;
+        while (!config.empty())
+        {
+            auto end = config.find(';');
+            auto entry = config.substr(0, end);
+            config = (end == std::string_view::npos) ? std::string_view{} : config.substr(end + 1);
+
+            int index;
+            Config field;
+            if (!parseEntry(entry, index, field))
+            {
+                if (!entry.empty())
+                    ESP_LOGW(TAG, "Invalid entry [%.*s]", static_cast<int>(entry.size()), entry.data());
+                continue;
+            }
+            _config[index] = field;
+            ++configured;
+        }
+        reset();
+        return configured;
+    }
+
+    /// @brief Next sample passes through as is (e.g. after a long gap)
+    void reset() { _primed = false; }
+
+    /// @brief Conditions one snapshot
+    /// @param in raw values
+    /// @return frame with conditioned and raw values and the fields that moved past their deadband
+    SolaxFrame process(const SolaxParameters &in)
+    {
+        for (int i = 0; i < SolaxFields::count; ++i)
+        {
+            const Config &config = _config[i];
+            State &state = _state[i];
+            const int32_t raw = SolaxFields::at(in, i);
+
+            if (!_primed)
+            {
+                state.filtered = static_cast<int64_t>(raw) * AlphaOne;
+                state.samples = 0;
+                SolaxFields::at(_frame.params, i) = raw;
+                _frame.changed |= SolaxFields::bit(i);
+                continue;
+            }
+
+            // filtered += alpha * (raw - filtered), Q8
+            state.filtered += (static_cast<int64_t>(raw) * AlphaOne - state.filtered) * config.alpha / AlphaOne;
+
+            if (++state.samples < config.decimation)
+                continue;
+            state.samples = 0;
+
+            const int32_t value = static_cast<int32_t>((state.filtered + (state.filtered < 0 ? -AlphaOne / 2 : AlphaOne / 2)) / AlphaOne);
+            int32_t &output = SolaxFields::at(_frame.params, i);
+            const int64_t delta = std::llabs(static_cast<int64_t>(value) - output);
+            if (delta != 0 && delta >= config.deadband)
+            {
+                output = value;
+                _frame.changed |= SolaxFields::bit(i);
+            }
+        }
+
+        _primed = true;
+        SolaxFrame frame = _frame;
+        frame.raw = in;
+        _frame.changed = 0;
+        return frame;
+    }
+
+private:
+    static constexpr const char *TAG = "SignalConditioner";
+
+    struct State
+    {
+        int64_t filtered{0}; // Q8
+        uint16_t samples{0};
+    };
+
+    static bool parseEntry(std::string_view entry, int &index, Config &config)
+    {
+        std::array<std::string_view, 4> parts;
+        size_t count = 0;
+        while (count < parts.size())
+        {
+            auto end = entry.find(':');
+            parts[count++] = entry.substr(0, end);
+            if (end == std::string_view::npos)
+                break;
+            entry = entry.substr(end + 1);
+        }
+        if (count != parts.size() || parts.back().find(':') != std::string_view::npos)
+            return false;
+
+        index = SolaxFields::find(parts[0]);
+        float alpha = 0;
+        int32_t deadband = 0;
+        uint16_t decimation = 0;
+        if (index == SolaxFields::NotFound || !number(parts[1], alpha) || !number(parts[2], deadband) || !number(parts[3], decimation))
+            return false;
+        if (alpha <= 0.0f || alpha > 1.0f || deadband < 0 || decimation == 0)
+            return false;
+
+        config.alpha = static_cast<int32_t>(alpha * AlphaOne + 0.5f);
+        config.alpha = config.alpha < 1 ? 1 : config.alpha;
+        config.deadband = deadband;
+        config.decimation = decimation;
+        return true;
+    }
+
+    template <typename T>
+    static bool number(std::string_view text, T &value)
+    {
+        auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return ec == std::errc() && end == text.data() + text.size();
+    }
+
+    std::array<Config, SolaxFields::count> _config{};
+    std::array<State, SolaxFields::count> _state{};
+    SolaxFrame _frame{};
+    bool _primed{false};
+};
@@ -0,0 +1,103 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2024 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   snapshot_mailbox.h
+/// @author Petr Vanek
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/// @brief Single-slot "latest value" channel guarded by a sequence lock.
+///        The producer overwrites the slot and never waits, the consumer always
+///        gets the newest complete snapshot and never a backlog. One producer
+///        (callers must be serialized) and one consumer.
+template <typename T>
+class SnapshotMailbox
+{
+    static_assert(std::is_trivially_copyable_v<T>, "snapshot must be trivially copyable");
+    static_assert(sizeof(T) % sizeof(uint32_t) == 0, "snapshot size must be a multiple of 4 bytes");
+
+public:
+    /// @brief Stores a new snapshot, an unread one is overwritten
+    void publish(const T &data)
+    {
+        std::array<uint32_t, Words> words;
+        std::memcpy(words.data(), &data, sizeof(T));
+
+        const uint32_t seq = _seq.load(std::memory_order_relaxed);
+        if (seq != _consumedSeq.load(std::memory_order_relaxed))
+        {
+            _overwritten.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        _seq.store(seq + 1, std::memory_order_relaxed); // odd - write in progress
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < Words; ++i)
+        {
+            _words[i].store(words[i], std::memory_order_relaxed);
+        }
+        _seq.store(seq + 2, std::memory_order_release);
+        _published.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// @brief Reads the newest snapshot, does not block
+    /// @return false if nothing new was published since the last fetch
+    bool fetch(T &out)
+    {
+        std::array<uint32_t, Words> words;
+
+        for (int attempt = 0; attempt < MaxAttempts; ++attempt)
+        {
+            const uint32_t begin = _seq.load(std::memory_order_acquire);
+            if (begin == _consumedSeq.load(std::memory_order_relaxed))
+            {
+                return false;
+            }
+
+            if (begin & 1)
+            {
+                continue; // producer is writing
+            }
+
+            for (size_t i = 0; i < Words; ++i)
+            {
+                words[i] = _words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (_seq.load(std::memory_order_relaxed) == begin)
+            {
+                std::memcpy(static_cast<void *>(&out), words.data(), sizeof(T));
+                _consumedSeq.store(begin, std::memory_order_relaxed);
+                _consumed.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+
+        return false; // still being written, the next fetch picks it up
+    }
+
+    /// @brief Last published snapshot was not fetched yet
+    bool pending() const { return _seq.load(std::memory_order_relaxed) != _consumedSeq.load(std::memory_order_relaxed); }
+
+    uint32_t published() const { return _published.load(std::memory_order_relaxed); }
+    uint32_t overwritten() const { return _overwritten.load(std::memory_order_relaxed); }
+    uint32_t consumed() const { return _consumed.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t Words = sizeof(T) / sizeof(uint32_t);
+    static constexpr int MaxAttempts = 4;
+
+    std::array<std::atomic<uint32_t>, Words> _words{};
+    std::atomic<uint32_t> _seq{0};
+    std::atomic<uint32_t> _consumedSeq{0};
+    std::atomic<uint32_t> _published{0};
+    std::atomic<uint32_t> _overwritten{0};
+    std::atomic<uint32_t> _consumed{0};
+};
@@ -0,0 +1,113 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2024 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   solax_binary.h
+/// @author Petr Vanek
+
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include "esp_log.h"
+#include "mqtt_queue_data.h"
+#include "solax_fields.h"
+
+/// @brief Compact binary frame of SolaxParameters, alternative to JSON payloads.
+///
+///  offset  size  content
+///  0       1     magic 0xB5 (never the first byte of a JSON text)
+///  1       1     version
+///  2       4     field mask, little endian, bit n = SolaxFields::fields[n]
+///  6       4*k   int32 little endian values of the k fields in the mask, ascending bit order
+class SolaxBinary
+{
+public:
+    static constexpr uint8_t Magic = 0xB5;
+    static constexpr uint8_t Version = 1;
+    static constexpr size_t HeaderSize = 6;
+    static constexpr size_t MaxFrameSize = HeaderSize + 32 * sizeof(int32_t);
+
+    /// @brief Payload looks like a binary frame
+    static bool isFrame(std::string_view payload)
+    {
+        return !payload.empty() && static_cast<uint8_t>(payload[0]) == Magic;
+    }
+
+    /// @brief Updates parameters from a binary frame, all fields or none
+    /// @return mask of updated fields, 0 for a malformed frame
+    static SolaxFields::Mask decode(SolaxParameters &params, std::string_view payload)
+    {
+        if (payload.size() < HeaderSize || !isFrame(payload))
+        {
+            ESP_LOGE(TAG, "Short frame: %d", static_cast<int>(payload.size()));
+            return 0;
+        }
+
+        const auto *data = reinterpret_cast<const uint8_t *>(payload.data());
+        if (data[1] != Version)
+        {
+            ESP_LOGE(TAG, "Unsupported version: %d", data[1]);
+            return 0;
+        }
+
+        const uint32_t mask = read32(data + 2);
+        if (payload.size() < HeaderSize + std::popcount(mask) * sizeof(int32_t))
+        {
+            ESP_LOGE(TAG, "Truncated frame: %d", static_cast<int>(payload.size()));
+            return 0;
+        }
+
+        // fields unknown to this firmware have higher bits, their values trail and are ignored
+        const uint8_t *value = data + HeaderSize;
+        for (uint32_t bits = mask & SolaxFields::all; bits; bits &= bits - 1, value += sizeof(int32_t))
+        {
+            SolaxFields::at(params, std::countr_zero(bits)) = static_cast<int32_t>(read32(value));
+        }
+
+        return mask & SolaxFields::all;
+    }
+
+    /// @brief Writes a frame with fields selected by mask
+    /// @return frame size, 0 when the buffer is too small
+    static size_t encode(const SolaxParameters &params, SolaxFields::Mask mask, uint8_t *buffer, size_t size)
+    {
+        mask &= SolaxFields::all;
+        const size_t frameSize = HeaderSize + std::popcount(mask) * sizeof(int32_t);
+        if (size < frameSize)
+        {
+            return 0;
+        }
+
+        buffer[0] = Magic;
+        buffer[1] = Version;
+        write32(buffer + 2, mask);
+
+        uint8_t *value = buffer + HeaderSize;
+        for (uint32_t bits = mask; bits; bits &= bits - 1, value += sizeof(int32_t))
+        {
+            write32(value, static_cast<uint32_t>(SolaxFields::at(params, std::countr_zero(bits))));
+        }
+
+        return frameSize;
+    }
+
+private:
+    static constexpr const char *TAG = "SolaxBinary";
+
+    static uint32_t read32(const uint8_t *p)
+    {
+        return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+               (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    static void write32(uint8_t *p, uint32_t value)
+    {
+        p[0] = static_cast<uint8_t>(value);
+        p[1] = static_cast<uint8_t>(value >> 8);
+        p[2] = static_cast<uint8_t>(value >> 16);
+        p[3] = static_cast<uint8_t>(value >> 24);
+    }
+};
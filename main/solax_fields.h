@@ -0,0 +1,216 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2024 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   solax_fields.h
+/// @author Petr Vanek
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+#include "mqtt_queue_data.h"
+
+/// @brief Compile-time table of SolaxParameters fields addressed by gateway name.
+///        Names are resolved by a perfect hash generated at compile time,
+///        a new field needs only one entry in the table.
+class SolaxFields
+{
+public:
+    using Member = int32_t SolaxParameters::*;
+
+    // How values of several inverters combine into the site value
+    enum class Aggregate
+    {
+        Sum,     // powers, currents, energies
+        Average, // voltages, state of charge
+        Max,     // temperatures, alarm-like states
+        First    // modes - taken from the first inverter
+    };
+
+    struct Field
+    {
+        std::string_view name;
+        Member member;
+        Aggregate aggregate;
+    };
+
+    // the index is also the field number of the binary frame (solax_binary.h) - append only
+    static constexpr Field fields[] = {
+        {"PvVoltage1", &SolaxParameters::PvVoltage1, Aggregate::Average},
+        {"PvVoltage2", &SolaxParameters::PvVoltage2, Aggregate::Average},
+        {"PvCurrent1", &SolaxParameters::PvCurrent1, Aggregate::Sum},
+        {"PvCurrent2", &SolaxParameters::PvCurrent2, Aggregate::Sum},
+        {"Powerdc1", &SolaxParameters::Powerdc1, Aggregate::Sum},
+        {"Powerdc2", &SolaxParameters::Powerdc2, Aggregate::Sum},
+        {"BatVoltage_Charge1", &SolaxParameters::BatVoltage_Charge1, Aggregate::Average},
+        {"BatCurrent_Charge1", &SolaxParameters::BatCurrent_Charge1, Aggregate::Sum},
+        {"Batpower_Charge1", &SolaxParameters::Batpower_Charge1, Aggregate::Sum},
+        {"TemperatureBat", &SolaxParameters::TemperatureBat, Aggregate::Max},
+        {"BattCap", &SolaxParameters::BattCap, Aggregate::Average},
+        {"FeedinPower", &SolaxParameters::FeedinPower, Aggregate::Sum},
+        {"GridPower_R", &SolaxParameters::GridPower_R, Aggregate::Sum},
+        {"GridPower_S", &SolaxParameters::GridPower_S, Aggregate::Sum},
+        {"GridPower_T", &SolaxParameters::GridPower_T, Aggregate::Sum},
+        {"Etoday_togrid", &SolaxParameters::Etoday_togrid, Aggregate::Sum},
+        {"Temperature", &SolaxParameters::Temperature, Aggregate::Max},
+        {"RunMode", &SolaxParameters::RunMode, Aggregate::First},
+        {"BDCStatus", &SolaxParameters::BDCStatus, Aggregate::First},
+        {"GridStatus", &SolaxParameters::GridStatus, Aggregate::Max},
+        {"MPPTCount", &SolaxParameters::MPPTCount, Aggregate::Sum},
+        {"HDO", &SolaxParameters::Hdo, Aggregate::Max},
+    };
+
+    static constexpr int count = static_cast<int>(std::size(fields));
+    static constexpr int NotFound = -1;
+
+    // one bit per field index
+    using Mask = uint32_t;
+    static_assert(std::size(fields) <= 32, "SolaxFields::Mask is too narrow");
+    static constexpr Mask all = (count == 32) ? ~Mask{0} : ((Mask{1} << count) - 1);
+    static constexpr Mask bit(int index) { return Mask{1} << index; }
+
+    /// @brief Field index for the gateway name
+    /// @param name field name as received, no NUL terminator needed
+    /// @return index into fields, NotFound for unknown names
+    static constexpr int find(std::string_view name)
+    {
+        const int index = _slots[hash(name, _seed) & (SlotCount - 1)];
+        return (index != NotFound && fields[index].name == name) ? index : NotFound;
+    }
+
+    /// @brief Field index of the member, NotFound when it has no table entry
+    static constexpr int index(Member member)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            if (fields[i].member == member)
+                return i;
+        }
+        return NotFound;
+    }
+
+    /// @brief Mask of the given members, e.g. maskOf(&SolaxParameters::Powerdc1, &SolaxParameters::Powerdc2)
+    template <typename... Members>
+    static constexpr Mask maskOf(Members... members)
+    {
+        return (bit(index(members)) | ...);
+    }
+
+    /// @brief Value of the field with given index
+    static int32_t &at(SolaxParameters &params, int index) { return params.*(fields[index].member); }
+    static int32_t at(const SolaxParameters &params, int index) { return params.*(fields[index].member); }
+
+private:
+    static constexpr uint32_t SlotCount = 64; // power of two, > count
+    static_assert(SlotCount > std::size(fields), "enlarge SlotCount");
+
+    // FNV-1a, the seed replaces the offset basis
+    static constexpr uint32_t hash(std::string_view name, uint32_t seed)
+    {
+        uint32_t h = seed;
+        for (char c : name)
+        {
+            h ^= static_cast<uint8_t>(c);
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    static constexpr bool collisionFree(uint32_t seed)
+    {
+        std::array<bool, SlotCount> used{};
+        for (const auto &field : fields)
+        {
+            auto slot = hash(field.name, seed) & (SlotCount - 1);
+            if (used[slot])
+                return false;
+            used[slot] = true;
+        }
+        return true;
+    }
+
+    static constexpr uint32_t findSeed()
+    {
+        for (uint32_t seed = 2166136261u; seed < 2166136261u + 10000; ++seed)
+        {
+            if (collisionFree(seed))
+                return seed;
+        }
+        return 0;
+    }
+
+    static constexpr std::array<int8_t, SlotCount> buildSlots(uint32_t seed)
+    {
+        std::array<int8_t, SlotCount> slots{};
+        slots.fill(NotFound);
+        for (int i = 0; i < count; ++i)
+        {
+            slots[hash(fields[i].name, seed) & (SlotCount - 1)] = static_cast<int8_t>(i);
+        }
+        return slots;
+    }
+
+    static const uint32_t _seed;
+    static const std::array<int8_t, SlotCount> _slots;
+};
+
+/// @brief Arrival tick of every field, parallel to SolaxParameters.
+///        Stamping costs one store per updated field.
+class FieldTimes
+{
+public:
+    void stamp(SolaxFields::Mask updated, uint32_t now)
+    {
+        _seen |= updated;
+        while (updated)
+        {
+            _ticks[__builtin_ctz(updated)] = now;
+            updated &= updated - 1;
+        }
+    }
+
+    bool seen(int index) const { return _seen & SolaxFields::bit(index); }
+
+    /// @brief Ticks since the field arrived, UINT32_MAX when it never did
+    uint32_t age(int index, uint32_t now) const { return seen(index) ? now - _ticks[index] : UINT32_MAX; }
+
+    /// @brief Fields that arrived once but not within maxAge; never sent fields are not stale
+    SolaxFields::Mask stale(uint32_t now, uint32_t maxAge) const
+    {
+        SolaxFields::Mask mask = 0;
+        for (int i = 0; i < SolaxFields::count; ++i)
+        {
+            if (seen(i) && now - _ticks[i] > maxAge)
+                mask |= SolaxFields::bit(i);
+        }
+        return mask;
+    }
+
+private:
+    std::array<uint32_t, SolaxFields::count> _ticks{};
+    SolaxFields::Mask _seen{0};
+};
+
+/// @brief Snapshot with the fields that changed since the previous one
+struct SolaxFrame
+{
+    SolaxParameters params{};   // conditioned - widgets only
+    SolaxParameters raw{};      // as received - energy accounting, day files, metrics
+    SolaxFields::Mask changed{0};
+    SolaxFields::Mask stale{0}; // no update within the stale limit
+    FieldTimes times{};         // arrival ticks
+    bool synthetic{false};      // replay / demo - shown, never counted into energy or published
+};
+
+inline constexpr uint32_t SolaxFields::_seed = SolaxFields::findSeed();
+inline constexpr std::array<int8_t, SolaxFields::SlotCount> SolaxFields::_slots = SolaxFields::buildSlots(SolaxFields::_seed);
+static_assert([]
+              {
+                  for (int i = 0; i < SolaxFields::count; ++i)
+                      if (SolaxFields::find(SolaxFields::fields[i].name) != i)
+                          return false;
+                  return true; }(),
+              "no perfect hash seed found for SolaxFields");
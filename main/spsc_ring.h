@@ -0,0 +1,147 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2024 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   spsc_ring.h
+/// @author Petr Vanek
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+/// @brief Lock-free single producer / single consumer ring of (topic, payload)
+///        records stored back to back in a fixed buffer. A record never wraps,
+///        the unused end of the buffer is skipped instead. The producer never
+///        waits - a record that does not fit is dropped and counted.
+template <size_t Capacity>
+class SpscRing
+{
+    static_assert(Capacity % 4 == 0, "Capacity must be a multiple of 4");
+
+public:
+    struct Record
+    {
+        std::string_view topic;
+        std::string_view payload;
+    };
+
+    /// @brief Producer side - copies the record into the ring
+    /// @return false when the ring is full (record dropped)
+    bool push(std::string_view topic, std::string_view payload)
+    {
+        const size_t size = align(sizeof(Header) + topic.size() + payload.size());
+        if (topic.size() >= Skip || payload.size() >= Skip || size > Capacity)
+        {
+            _drops.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        const size_t head = _head.load(std::memory_order_relaxed);
+        const size_t tail = _tail.load(std::memory_order_acquire);
+        const size_t offset = head % Capacity;
+        const size_t padding = (offset + size > Capacity) ? Capacity - offset : 0;
+
+        if (Capacity - (head - tail) < padding + size)
+        {
+            _drops.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        if (padding)
+        {
+            writeHeader(offset, Header{Skip, 0});
+        }
+
+        const size_t start = (offset + padding) % Capacity;
+        writeHeader(start, Header{static_cast<uint16_t>(topic.size()), static_cast<uint16_t>(payload.size())});
+        std::memcpy(_buffer + start + sizeof(Header), topic.data(), topic.size());
+        std::memcpy(_buffer + start + sizeof(Header) + topic.size(), payload.data(), payload.size());
+
+        const size_t newHead = head + padding + size;
+        _head.store(newHead, std::memory_order_release);
+        _pushed.fetch_add(1, std::memory_order_relaxed);
+
+        const size_t used = newHead - tail;
+        if (used > _highWater.load(std::memory_order_relaxed))
+        {
+            _highWater.store(used, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    /// @brief Consumer side - oldest record, the views stay valid until pop()
+    bool peek(Record &record)
+    {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        const size_t head = _head.load(std::memory_order_acquire);
+        if (tail == head)
+        {
+            return false;
+        }
+
+        Header header = readHeader(tail % Capacity);
+        if (header.topicLength == Skip)
+        {
+            tail += Capacity - tail % Capacity;
+            _tail.store(tail, std::memory_order_release);
+            if (tail == head)
+            {
+                return false;
+            }
+            header = readHeader(tail % Capacity);
+        }
+
+        const char *data = reinterpret_cast<const char *>(_buffer + tail % Capacity + sizeof(Header));
+        record.topic = std::string_view(data, header.topicLength);
+        record.payload = std::string_view(data + header.topicLength, header.payloadLength);
+        return true;
+    }
+
+    /// @brief Consumer side - releases the record returned by peek()
+    void pop()
+    {
+        const size_t tail = _tail.load(std::memory_order_relaxed);
+        const Header header = readHeader(tail % Capacity);
+        _tail.store(tail + align(sizeof(Header) + header.topicLength + header.payloadLength), std::memory_order_release);
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+    /// @brief Largest topic + payload that an empty ring always accepts - a record
+    ///        never wraps, so past the middle of the buffer only half of it is usable
+    static constexpr size_t maxRecord() { return (Capacity / 2 & ~size_t{3}) - sizeof(Header); }
+    size_t used() const { return _head.load(std::memory_order_relaxed) - _tail.load(std::memory_order_relaxed); }
+    size_t highWater() const { return _highWater.load(std::memory_order_relaxed); }
+    uint32_t pushed() const { return _pushed.load(std::memory_order_relaxed); }
+    uint32_t drops() const { return _drops.load(std::memory_order_relaxed); }
+
+private:
+    struct Header
+    {
+        uint16_t topicLength;
+        uint16_t payloadLength;
+    };
+
+    static constexpr uint16_t Skip = 0xFFFF; // rest of the buffer is unused
+
+    static constexpr size_t align(size_t size) { return (size + 3) & ~size_t{3}; }
+
+    void writeHeader(size_t offset, const Header &header) { std::memcpy(_buffer + offset, &header, sizeof(Header)); }
+
+    Header readHeader(size_t offset) const
+    {
+        Header header;
+        std::memcpy(&header, _buffer + offset, sizeof(Header));
+        return header;
+    }
+
+    alignas(4) uint8_t _buffer[Capacity];
+    std::atomic<size_t> _head{0}; // total bytes written
+    std::atomic<size_t> _tail{0}; // total bytes released
+    std::atomic<size_t> _highWater{0};
+    std::atomic<uint32_t> _pushed{0};
+    std::atomic<uint32_t> _drops{0};
+};
@@ -112,9 +112,9 @@ void TimeTask::loop()
                 if (sntp_get_sync_status() == SNTP_SYNC_STATUS_RESET) 
                 {
                     initializeSNTP(); // Initialize SNTP only if it hasn't been started
-                    vTaskDelay(pdMS_TO_TICKS(1000));
                 }
                 initialSyncDone = true;
+                lastSyncTime = esp_timer_get_time();
             }
 
             int64_t now = esp_timer_get_time();
@@ -133,7 +133,11 @@ void TimeTask::loop()
                 }
 
                 lastSyncTime = esp_timer_get_time();
+                elapsedTime = 0;
             }
+
+            // sleep until the next sync or Wi-Fi loss
+            _connectionManager->waitDisconnected(pdMS_TO_TICKS(syncIntervalMs - elapsedTime));
         }
         else
         {
@@ -142,8 +146,15 @@ void TimeTask::loop()
                 ESP_LOGW(LOG_TAG, "Wi-Fi disconnected. Waiting for reconnection...");
                 initialSyncDone = false;
             }
-        }
 
-        vTaskDelay(pdMS_TO_TICKS(1000)); // Check every second
+            if (_connectionManager)
+            {
+                _connectionManager->waitConnected(portMAX_DELAY);
+            }
+            else
+            {
+                vTaskDelay(pdMS_TO_TICKS(1000));
+            }
+        }
     }
 }
@@ -0,0 +1,202 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2024 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   topic_trie.h
+/// @author Petr Vanek
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// @brief MQTT topic filter trie with '+' and '#' wildcard semantics.
+///        Matching walks the topic levels once (plus one branch per '+' filter),
+///        independent of the number of registered filters, and does not allocate.
+template <typename Value>
+class TopicTrie
+{
+public:
+    TopicTrie() : _nodes(1) {}
+
+    /// @brief Filter is a valid MQTT subscription filter
+    static bool isValidFilter(std::string_view filter)
+    {
+        if (filter.empty())
+            return false;
+
+        for (size_t i = 0; i < filter.size(); ++i)
+        {
+            const bool levelStart = (i == 0 || filter[i - 1] == '/');
+            const bool levelEnd = (i + 1 == filter.size() || filter[i + 1] == '/');
+            if (filter[i] == '+' && !(levelStart && levelEnd))
+                return false;
+            if (filter[i] == '#' && !(levelStart && i + 1 == filter.size()))
+                return false;
+        }
+        return true;
+    }
+
+    /// @brief Registers value for the filter, an existing value is replaced
+    bool insert(std::string_view filter, const Value &value)
+    {
+        if (!isValidFilter(filter))
+            return false;
+
+        int index = 0;
+        forEachLevel(filter, [&](std::string_view level)
+                     { index = addChild(index, level); });
+
+        Node &node = _nodes[index];
+        node.used = true;
+        node.value = value;
+        node.filter.assign(filter);
+        return true;
+    }
+
+    /// @brief Removes the filter, nodes are kept for later registrations
+    bool remove(std::string_view filter)
+    {
+        const int index = find(filter);
+        if (index < 0)
+            return false;
+
+        _nodes[index].used = false;
+        _nodes[index].value = Value{};
+        return true;
+    }
+
+    bool contains(std::string_view filter) const { return find(filter) >= 0; }
+
+    /// @brief Calls fn(const Value &) for every filter matching the topic
+    template <typename Fn>
+    void match(std::string_view topic, Fn &&fn) const
+    {
+        if (!topic.empty())
+            matchNode(0, topic, 0, fn);
+    }
+
+    /// @brief Calls fn(std::string_view filter, const Value &) for every registered filter
+    template <typename Fn>
+    void forEach(Fn &&fn) const
+    {
+        for (const auto &node : _nodes)
+        {
+            if (node.used)
+                fn(std::string_view(node.filter), node.value);
+        }
+    }
+
+private:
+    struct Node
+    {
+        std::string level;
+        std::vector<int> children; // exact levels
+        int plus{-1};              // '+' child
+        int hash{-1};              // '#' child
+        bool used{false};
+        Value value{};
+        std::string filter;
+    };
+
+    template <typename Fn>
+    static void forEachLevel(std::string_view text, Fn &&fn)
+    {
+        size_t pos = 0;
+        while (true)
+        {
+            const size_t end = text.find('/', pos);
+            fn(text.substr(pos, end == std::string_view::npos ? std::string_view::npos : end - pos));
+            if (end == std::string_view::npos)
+                break;
+            pos = end + 1;
+        }
+    }
+
+    int findChild(int index, std::string_view level) const
+    {
+        const Node &node = _nodes[index];
+        if (level == "+")
+            return node.plus;
+        if (level == "#")
+            return node.hash;
+
+        for (int c : node.children)
+        {
+            if (_nodes[c].level == level)
+                return c;
+        }
+        return -1;
+    }
+
+    int addChild(int index, std::string_view level)
+    {
+        int found = findChild(index, level);
+        if (found >= 0)
+            return found;
+
+        found = static_cast<int>(_nodes.size());
+        if (level == "+")
+            _nodes[index].plus = found;
+        else if (level == "#")
+            _nodes[index].hash = found;
+        else
+            _nodes[index].children.push_back(found);
+
+        _nodes.emplace_back();
+        _nodes.back().level.assign(level);
+        return found;
+    }
+
+    int find(std::string_view filter) const
+    {
+        int index = 0;
+        forEachLevel(filter, [&](std::string_view level)
+                     { index = (index < 0) ? -1 : findChild(index, level); });
+        return (index >= 0 && _nodes[index].used) ? index : -1;
+    }
+
+    template <typename Fn>
+    void emit(int index, Fn &fn) const
+    {
+        if (index >= 0 && _nodes[index].used)
+            fn(_nodes[index].value);
+    }
+
+    // pos is the start of the next topic level, npos when all levels were consumed
+    template <typename Fn>
+    void matchNode(int index, std::string_view topic, size_t pos, Fn &fn) const
+    {
+        const Node &node = _nodes[index];
+        if (pos == std::string_view::npos)
+        {
+            emit(index, fn);
+            emit(node.hash, fn); // "a/#" matches "a" too
+            return;
+        }
+
+        // wildcards at the first level never match "$SYS" like topics
+        const bool wildcards = !(index == 0 && topic[0] == '$');
+        if (wildcards)
+            emit(node.hash, fn);
+
+        const size_t end = topic.find('/', pos);
+        const std::string_view level = topic.substr(pos, end == std::string_view::npos ? std::string_view::npos : end - pos);
+        const size_t next = (end == std::string_view::npos) ? std::string_view::npos : end + 1;
+
+        for (int c : node.children)
+        {
+            if (_nodes[c].level == level)
+            {
+                matchNode(c, topic, next, fn);
+                break;
+            }
+        }
+
+        if (wildcards && node.plus >= 0)
+            matchNode(node.plus, topic, next, fn);
+    }
+
+    std::vector<Node> _nodes; // [0] is the root
+};
@@ -13,6 +13,11 @@
 #include <iomanip>
 #include <cctype>
 #include <string_view>
+#include <algorithm>
+#include <charconv>
+#include <tuple>
+#include <cmath>
+#include <cstring>
 #include <time.h>
 #include "esp_sntp.h"
 #include "esp_log.h"
@@ -23,6 +28,57 @@ class Utils
 private:
     static constexpr const char *TAG = "UTILS";
 
+    /// @brief Appends into a fixed buffer, truncating, always NUL terminated.
+    class FixedText
+    {
+    public:
+        FixedText(char *buf, size_t size) : _buf(buf), _end(size ? buf + size - 1 : buf), _pos(buf), _valid(size > 0)
+        {
+            if (_valid)
+                *_pos = '\0';
+        }
+
+        void text(std::string_view str)
+        {
+            if (!_valid)
+                return;
+            size_t len = std::min(str.size(), static_cast<size_t>(_end - _pos));
+            std::memcpy(_pos, str.data(), len);
+            _pos += len;
+            *_pos = '\0';
+        }
+
+        template <typename T>
+        void number(T value)
+        {
+            if (!_valid)
+                return;
+            auto res = std::to_chars(_pos, _end, value);
+            _pos = res.ec == std::errc() ? res.ptr : _end;
+            *_pos = '\0';
+        }
+
+        // zero padded fractional digits
+        void fraction(uint32_t value, int digits)
+        {
+            char tmp[8];
+            for (int i = digits - 1; i >= 0; i--)
+            {
+                tmp[i] = static_cast<char>('0' + value % 10);
+                value /= 10;
+            }
+            text(std::string_view(tmp, digits));
+        }
+
+        size_t length() const { return _pos - _buf; }
+
+    private:
+        char *_buf;
+        char *_end;
+        char *_pos;
+        bool _valid;
+    };
+
 public:
     static std::string urlDecode(std::string_view encoded)
     {
@@ -111,21 +167,62 @@ public:
         return {std::string(dateBuffer), std::string(timeBuffer)};
     }
 
-    static std::string formatPower(int32_t powr, std::string_view unit = "W", std::string_view append="")
+    /// @brief Formats power into a caller buffer without heap or locale:
+    ///        "950 W", "-1.25 kW", "12.40 kWh" (unit "W", append "h").
+    ///        Kilo values use integer fixed point rounded half away from zero.
+    /// @return number of characters written, always NUL terminated
+    static size_t formatPower(char *buf, size_t size, int32_t powr, std::string_view unit = "W", std::string_view append = "")
     {
-        std::ostringstream oss;
-        if (abs(powr) < 1000)
+        FixedText out(buf, size);
+        int64_t value = powr;
+        bool negative = value < 0;
+        uint64_t magnitude = negative ? -value : value;
+
+        if (magnitude < 1000)
         {
-            oss << powr << " " << unit << append;
+            out.number(value);
+            out.text(" ");
         }
         else
         {
-            double kilowatts = powr / 1000.0;
-            oss << std::fixed << std::setprecision(2) << kilowatts << " k" << unit << append;
+            uint64_t hundredths = (magnitude + 5) / 10;
+            if (negative)
+                out.text("-");
+            out.number(hundredths / 100);
+            out.text(".");
+            out.fraction(hundredths % 100, 2);
+            out.text(" k");
+        }
+        out.text(unit);
+        out.text(append);
+        return out.length();
+    }
+
+    /// @brief Formats a temperature with one decimal, e.g. "23.5 °C".
+    static size_t formatTemperature(char *buf, size_t size, float temp)
+    {
+        FixedText out(buf, size);
+        int32_t tenths = static_cast<int32_t>(lroundf(temp * 10.0f));
+        if (tenths < 0)
+        {
+            out.text("-");
+            tenths = -tenths;
         }
-        return oss.str();
+        out.number(tenths / 10);
+        out.text(".");
+        out.fraction(tenths % 10, 1);
+        out.text(" °C");
+        return out.length();
     }
 
+    /// @brief Formats a percentage, e.g. "87%".
+    static size_t formatPercent(char *buf, size_t size, int percentage)
+    {
+        FixedText out(buf, size);
+        out.number(percentage);
+        out.text("%");
+        return out.length();
+    }
 
 static std::string toHexString(const std::string &input) {
     std::ostringstream hexStream;
@@ -6,6 +6,8 @@
 /// @file   web_task.cpp
 /// @author Petr Vanek
 
+#include <cinttypes>
+#include <cstdarg>
 #include <stdio.h>
 #include <memory.h>
 #include <math.h>
@@ -19,6 +21,7 @@
 #include "http_request.h"
 #include <cJSON.h>
 #include "utils.h"
+#include "sdkconfig.h"
 
 WebTask::WebTask()
 {
@@ -82,6 +85,13 @@ void WebTask::loop()
 				ESP_LOGI(TAG,"http server mode -> stop");
 				server.stop();
 			}
+			else if (mode == Mode::Diagnostics)
+			{
+				ESP_LOGI(TAG,"http server mode -> diagnostics");
+				server.stop();
+				server.start();
+				registerStats(server);
+			}
 			else if (mode == Mode::Setting)
 			{
 				server.stop();
@@ -97,6 +107,8 @@ void WebTask::loop()
 			
 
 
+				registerStats(server);
+
 				// AP main page
 				server.registerUriHandler("/", HTTP_GET, [&apinfo](httpd_req_t *req) -> esp_err_t {
 						
@@ -209,6 +221,63 @@ void WebTask::loop()
 	}
 }
 
+void WebTask::registerStats(HttpServer &server)
+{
+	// display render / flush statistics
+	server.registerUriHandler("/stats", HTTP_GET, [](httpd_req_t *req) -> esp_err_t
+							  {
+#if CONFIG_PVVIEW_DISPLAY_STATS
+				std::unique_ptr<char[]> json(new char[StatsJsonSize]);
+				size_t len = DisplayDriver::statsJson(json.get(), StatsJsonSize);
+				if (!len) {
+					ESP_LOGE(TAG, "Statistics do not fit %u B", static_cast<unsigned>(StatsJsonSize));
+					httpd_resp_send_500(req);
+					return ESP_OK;
+				}
+				httpd_resp_set_type(req, "application/json");
+				httpd_resp_send(req, json.get(), len);
+#else
+				httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "statistics disabled");
+#endif
+				return ESP_OK; });
+
+	// per-inverter values (the display shows the site total only) and the ingest ring
+	server.registerUriHandler("/ingest", HTTP_GET, [](httpd_req_t *req) -> esp_err_t
+							  {
+				IngestTask *ingest = Application::getInstance()->getIngestTask();
+				std::unique_ptr<char[]> json(new char[StatsJsonSize]);
+				size_t len = 0;
+				auto append = [&json, &len](const char *fmt, ...)
+				{
+					va_list args;
+					va_start(args, fmt);
+					const int n = vsnprintf(json.get() + len, StatsJsonSize - len, fmt, args);
+					va_end(args);
+					len = (n < 0 || static_cast<size_t>(n) >= StatsJsonSize - len) ? StatsJsonSize : len + n;
+				};
+
+				append("{\"inverters\":[");
+				SolaxParameters inverter;
+				for (int i = 0; i < ingest->inverterCount() && ingest->getInverter(i, inverter); ++i) {
+					append("%s{\"pv\":%" PRId32 ",\"feedin\":%" PRId32 ",\"output\":%" PRId32 ",\"battery\":%" PRId32 ",\"soc\":%" PRId32 ",\"temperature\":%" PRId32 "}",
+						   i ? "," : "", inverter.Powerdc1 + inverter.Powerdc2, inverter.FeedinPower,
+						   inverter.GridPower_R + inverter.GridPower_S + inverter.GridPower_T,
+						   inverter.Batpower_Charge1, inverter.BattCap, inverter.Temperature);
+				}
+				append("],\"ring\":{\"used\":%u,\"high_water\":%u,\"capacity\":%u,\"drops\":%" PRIu32 "}}",
+					   static_cast<unsigned>(ingest->ringUsed()), static_cast<unsigned>(ingest->ringHighWater()),
+					   static_cast<unsigned>(IngestTask::RingSize), ingest->ringDrops());
+
+				if (len >= StatsJsonSize) {
+					ESP_LOGE(TAG, "Ingest state does not fit %u B", static_cast<unsigned>(StatsJsonSize));
+					httpd_resp_send_500(req);
+					return ESP_OK;
+				}
+				httpd_resp_set_type(req, "application/json");
+				httpd_resp_send(req, json.get(), len);
+				return ESP_OK; });
+}
+
 void WebTask::apInfo(const APInfo &ap)
 {
 	if (_queueAP)
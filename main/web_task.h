@@ -13,6 +13,7 @@
 #include "literals.h"
 #include "wifi_scanner.h"
 
+class HttpServer;
 
 class WebTask : public RPTask
 {
@@ -20,7 +21,8 @@ public:
  enum class Mode {
 		ClearAPInfo,
 	    Setting,     	
-        Stop       };
+        Stop,
+		Diagnostics };	// STA mode - statistics endpoints only
 
 	WebTask();
 	virtual ~WebTask();
@@ -32,6 +34,11 @@ protected:
 
 private:
 	static constexpr const char *TAG = "WebTask";
+	static constexpr size_t StatsJsonSize = 1024;
+
+	// /stats - display render / flush statistics, /ingest - inverters and ring;
+	// both in AP setting and STA mode
+	static void registerStats(HttpServer &server);
 
 	Mode            _mode {Mode::Stop};
 	QueueHandle_t 	_queue;
@@ -179,8 +179,8 @@ void WifiTask::processMessage(const Mode& mode, WiFiAccessPoint& wftt,	WiFiClien
 					cntok = wfcli.connect(kv.readString(literals::kv_ssid), kv.readString(literals::kv_passwd), false, &staticip);
 				}
 
-				// no nedded web interface
-				Application::getInstance()->getWebTask()->command(WebTask::Mode::Stop);
+				// no setting pages, statistics only
+				Application::getInstance()->getWebTask()->command(WebTask::Mode::Diagnostics);
 			}
 			else if (mode == Mode::AP)
 			{
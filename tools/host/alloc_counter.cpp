@@ -0,0 +1,48 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2025 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   alloc_counter.cpp
+/// @author Petr Vanek
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "alloc_counter.h"
+
+namespace
+{
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> allocatedBytes{0};
+
+    void *allocate(size_t size)
+    {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+        return std::malloc(size ? size : 1);
+    }
+}
+
+uint64_t AllocCounter::count() { return allocations.load(std::memory_order_relaxed); }
+uint64_t AllocCounter::bytes() { return allocatedBytes.load(std::memory_order_relaxed); }
+
+void *AllocCounter::countedMalloc(size_t size) { return allocate(size); }
+void AllocCounter::countedFree(void *ptr) { std::free(ptr); }
+
+void *operator new(size_t size)
+{
+    if (void *ptr = allocate(size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+void *operator new(size_t size, const std::nothrow_t &) noexcept { return allocate(size); }
+void *operator new[](size_t size, const std::nothrow_t &) noexcept { return allocate(size); }
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, const std::nothrow_t &) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept { std::free(ptr); }
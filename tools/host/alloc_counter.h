@@ -0,0 +1,35 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2025 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   alloc_counter.h
+/// @author Petr Vanek
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/// @brief Heap allocations made by the host harness. Every operator new is
+///        counted; C code (cJSON) is counted when it is given countedMalloc().
+namespace AllocCounter
+{
+    uint64_t count();
+    uint64_t bytes();
+
+    void *countedMalloc(size_t size);
+    void countedFree(void *ptr);
+
+    /// @brief Allocations made between construction and allocations()
+    class Scope
+    {
+    public:
+        Scope() : _count(count()), _bytes(bytes()) {}
+        uint64_t allocations() const { return count() - _count; }
+        uint64_t allocatedBytes() const { return bytes() - _bytes; }
+
+    private:
+        uint64_t _count;
+        uint64_t _bytes;
+    };
+}
@@ -0,0 +1,155 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2025 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   bench_dispatch.cpp
+/// @author Petr Vanek
+///
+/// MQTT_EVENT_DATA dispatch: heap allocations and time per message of Mqtt
+/// against the former std::string + std::map handler.
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include "alloc_counter.h"
+#include "mqtt.h"
+
+namespace
+{
+    constexpr int Messages = 200000;
+    constexpr int FragmentSize = 64; // chunk size of the fragmented run
+
+    const char *const Payloads[] = {
+        R"({"name":"Powerdc1","value":1234})",
+        R"({"name":"GridPower_R","value":-512})",
+        R"({"name":"BatVoltage_Charge1","value":2105})",
+        R"({"name":"Temperature","value":41})",
+    };
+
+    struct Result
+    {
+        double nsPerMessage;
+        double allocationsPerMessage;
+    };
+
+    template <typename Fn>
+    Result measure(int messages, Fn &&deliver)
+    {
+        AllocCounter::Scope scope;
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < messages; ++i)
+            deliver(i);
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        return {std::chrono::duration<double, std::nano>(elapsed).count() / messages,
+                static_cast<double>(scope.allocations()) / messages};
+    }
+
+    // the handler as it was - two strings and a map lookup per message
+    class LegacyDispatch
+    {
+    public:
+        void subscribe(const std::string &topic, MqttMessageCallback callback) { _topicCallbacks[topic] = callback; }
+
+        void onData(esp_mqtt_event_handle_t event)
+        {
+            std::string topic(event->topic, event->topic_len);
+            std::string message(event->data, event->data_len);
+
+            auto it = _topicCallbacks.find(topic);
+            if (it != _topicCallbacks.end() && it->second)
+                it->second(topic, message);
+        }
+
+    private:
+        std::map<std::string, MqttMessageCallback> _topicCallbacks;
+    };
+
+    void report(const char *name, const Result &result)
+    {
+        std::printf("%-28s %8.1f ns/msg %8.2f allocations/msg\n", name, result.nsPerMessage, result.allocationsPerMessage);
+    }
+}
+
+int main()
+{
+    char topic[] = "solax/data";
+    std::vector<std::string> payloads(std::begin(Payloads), std::end(Payloads));
+    size_t received = 0;
+    auto callback = [&received](std::string_view, std::string_view message)
+    { received += message.size(); };
+
+    auto dataEvent = [&](int i)
+    {
+        std::string &payload = payloads[i % payloads.size()];
+        esp_mqtt_event_t event;
+        event.event_id = MQTT_EVENT_DATA;
+        event.topic = topic;
+        event.topic_len = static_cast<int>(std::strlen(topic));
+        event.data = payload.data();
+        event.data_len = static_cast<int>(payload.size());
+        event.total_data_len = event.data_len;
+        return event;
+    };
+
+    LegacyDispatch legacy;
+    legacy.subscribe(topic, callback);
+    auto legacyResult = measure(Messages, [&](int i)
+                                { auto event = dataEvent(i); legacy.onData(&event); });
+
+    Mqtt mqtt;
+    mqtt.init("mqtt://host");
+    mqtt.subscribe("solax/+", callback);
+    esp_mqtt_event_t connected;
+    connected.event_id = MQTT_EVENT_CONNECTED;
+    hostMqttDeliver(connected);
+
+    auto viewResult = measure(Messages, [&](int i)
+                              { auto event = dataEvent(i); hostMqttDeliver(event); });
+
+    // one large payload in chunks, the reassembly buffer is allocated by the first message
+    std::string large = "[";
+    for (int i = 0; i < 20; ++i)
+        large += std::string(i ? "," : "") + R"({"name":"Powerdc1","value":)" + std::to_string(i) + "}";
+    large += "]";
+
+    auto fragmented = [&](int)
+    {
+        esp_mqtt_event_t event;
+        event.event_id = MQTT_EVENT_DATA;
+        event.total_data_len = static_cast<int>(large.size());
+        for (size_t offset = 0; offset < large.size(); offset += FragmentSize)
+        {
+            // esp-mqtt sends the topic with the first chunk only
+            event.topic = offset ? nullptr : topic;
+            event.topic_len = offset ? 0 : static_cast<int>(std::strlen(topic));
+            event.data = large.data() + offset;
+            event.data_len = static_cast<int>(std::min<size_t>(FragmentSize, large.size() - offset));
+            event.current_data_offset = static_cast<int>(offset);
+            hostMqttDeliver(event);
+        }
+    };
+    fragmented(0);
+    auto fragmentedResult = measure(Messages / 10, fragmented);
+
+    std::printf("payload %zu B, fragmented %zu B in %d B chunks, %zu B received\n",
+                payloads[0].size(), large.size(), FragmentSize, received);
+    report("std::string + std::map", legacyResult);
+    report("string_view + topic trie", viewResult);
+    report("fragmented, pooled buffer", fragmentedResult);
+
+    // a session kept by the broker need not hold every filter - connect always resubscribes
+    esp_mqtt_event_t disconnected;
+    disconnected.event_id = MQTT_EVENT_DISCONNECTED;
+    hostMqttDeliver(disconnected);
+    const int subscribes = hostMqttClient->subscribes;
+    mqtt.subscribe("solax/cmd", callback); // offline, queued until connect
+    connected.session_present = 1;
+    hostMqttDeliver(connected);
+    const bool resubscribed = hostMqttClient->subscribes - subscribes == 2;
+    std::printf("reconnect with a session: %d filters subscribed\n", hostMqttClient->subscribes - subscribes);
+
+    return (resubscribed && viewResult.allocationsPerMessage == 0 && fragmentedResult.allocationsPerMessage == 0) ? 0 : 1;
+}
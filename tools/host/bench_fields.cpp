@@ -0,0 +1,98 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2025 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   bench_fields.cpp
+/// @author Petr Vanek
+///
+/// ns per field lookup: the former std::string == chain against the
+/// compile-time perfect hash of SolaxFields.
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "mqtt_queue_data.h"
+#include "solax_fields.h"
+
+namespace
+{
+    constexpr int Rounds = 200000;
+    volatile int sink; // keeps the results alive
+
+    // the lookup as it was, the caller had to build a std::string
+    bool legacyUpdate(SolaxParameters &params, const std::string &key, int32_t value)
+    {
+        if (key == "PvVoltage1") params.PvVoltage1 = value;
+        else if (key == "PvVoltage2") params.PvVoltage2 = value;
+        else if (key == "PvCurrent1") params.PvCurrent1 = value;
+        else if (key == "PvCurrent2") params.PvCurrent2 = value;
+        else if (key == "Powerdc1") params.Powerdc1 = value;
+        else if (key == "Powerdc2") params.Powerdc2 = value;
+        else if (key == "BatVoltage_Charge1") params.BatVoltage_Charge1 = value;
+        else if (key == "BatCurrent_Charge1") params.BatCurrent_Charge1 = value;
+        else if (key == "Batpower_Charge1") params.Batpower_Charge1 = value;
+        else if (key == "TemperatureBat") params.TemperatureBat = value;
+        else if (key == "BattCap") params.BattCap = value;
+        else if (key == "FeedinPower") params.FeedinPower = value;
+        else if (key == "GridPower_R") params.GridPower_R = value;
+        else if (key == "GridPower_S") params.GridPower_S = value;
+        else if (key == "GridPower_T") params.GridPower_T = value;
+        else if (key == "Etoday_togrid") params.Etoday_togrid = value;
+        else if (key == "Temperature") params.Temperature = value;
+        else if (key == "RunMode") params.RunMode = value;
+        else if (key == "BDCStatus") params.BDCStatus = value;
+        else if (key == "GridStatus") params.GridStatus = value;
+        else if (key == "MPPTCount") params.MPPTCount = value;
+        else if (key == "HDO") params.Hdo = value;
+        else return false; // the unknown key warning is left out, it would dominate
+        return true;
+    }
+
+    bool hashedUpdate(SolaxParameters &params, std::string_view key, int32_t value)
+    {
+        const int index = SolaxFields::find(key);
+        if (index == SolaxFields::NotFound)
+            return false;
+        SolaxFields::at(params, index) = value;
+        return true;
+    }
+
+    template <typename Fn>
+    double nsPerLookup(const std::vector<std::string_view> &keys, Fn &&update)
+    {
+        SolaxParameters params;
+        int hits = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int round = 0; round < Rounds; ++round)
+        {
+            for (auto key : keys)
+                hits += update(params, key, round);
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        sink = hits + params.Hdo;
+        return std::chrono::duration<double, std::nano>(elapsed).count() / (static_cast<double>(Rounds) * keys.size());
+    }
+
+    void run(const char *name, const std::vector<std::string_view> &keys)
+    {
+        const double legacy = nsPerLookup(keys, [](SolaxParameters &params, std::string_view key, int32_t value)
+                                          { return legacyUpdate(params, std::string(key), value); });
+        const double hashed = nsPerLookup(keys, hashedUpdate);
+        std::printf("%-14s string chain %7.2f ns/lookup   perfect hash %6.2f ns/lookup\n", name, legacy, hashed);
+    }
+}
+
+int main()
+{
+    std::vector<std::string_view> known;
+    for (const auto &field : SolaxFields::fields)
+        known.push_back(field.name);
+
+    const std::vector<std::string_view> unknown = {"Pv", "PowerdcX", "BatteryTemperature", "GridPower", "Etotal_togrid", "Mode"};
+
+    run("known keys", known);
+    run("unknown keys", unknown);
+    return 0;
+}
@@ -0,0 +1,88 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2025 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   bench_format.cpp
+/// @author Petr Vanek
+///
+/// Dashboard number formatting: the former std::ostringstream formatPower against
+/// Utils::formatPower into a stack buffer, plus the temperature text.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include "alloc_counter.h"
+#include "utils.h"
+
+namespace
+{
+    constexpr int32_t Range = 200000; // -200 kW .. 200 kW
+    constexpr int32_t Step = 7;
+
+    volatile size_t sink; // keeps the results alive
+
+    // the formatter as it was
+    std::string legacyFormatPower(int32_t powr, std::string_view unit = "W", std::string_view append = "")
+    {
+        std::ostringstream oss;
+        if (abs(powr) < 1000)
+        {
+            oss << powr << " " << unit << append;
+        }
+        else
+        {
+            double kilowatts = powr / 1000.0;
+            oss << std::fixed << std::setprecision(2) << kilowatts << " k" << unit << append;
+        }
+        return oss.str();
+    }
+
+    template <typename Fn>
+    void run(const char *name, Fn &&format)
+    {
+        AllocCounter::Scope scope;
+        size_t length = 0;
+        uint64_t calls = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int32_t value = -Range; value <= Range; value += Step, ++calls)
+            length += format(value);
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        sink = length;
+        std::printf("%-34s %7.1f ns/call %6.2f allocations/call\n", name,
+                    std::chrono::duration<double, std::nano>(elapsed).count() / calls, static_cast<double>(scope.allocations()) / calls);
+    }
+}
+
+int main()
+{
+    // both paths agree except on exact .xx5 ties (decimal vs binary rounding)
+    int differences = 0;
+    for (int32_t value = -Range; value <= Range; ++value)
+    {
+        char text[32];
+        Utils::formatPower(text, sizeof(text), value, "W", "h");
+        if (legacyFormatPower(value, "W", "h") != text && (std::abs(value) % 10) != 5)
+            ++differences;
+    }
+    std::printf("outputs differing other than on .xx5 ties: %d\n", differences);
+
+    run("ostringstream formatPower", [](int32_t value)
+        { return legacyFormatPower(value).size(); });
+    run("Utils::formatPower (buffer)", [](int32_t value)
+        {
+            char text[32];
+            return Utils::formatPower(text, sizeof(text), value); });
+    run("snprintf %.1f °C", [](int32_t value)
+        {
+            char text[20];
+            return static_cast<size_t>(std::snprintf(text, sizeof(text), "%.1f °C", value / 1000.0f)); });
+    run("Utils::formatTemperature", [](int32_t value)
+        {
+            char text[20];
+            return Utils::formatTemperature(text, sizeof(text), value / 1000.0f); });
+
+    return differences ? 1 : 0;
+}
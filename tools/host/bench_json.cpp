@@ -0,0 +1,149 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2025 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   bench_json.cpp
+/// @author Petr Vanek
+///
+/// Gateway name/value messages parsed by JsonSerializer (in-place JsonReader)
+/// and, when the build found cJSON, by the former cJSON DOM path.
+///
+///   bench_json [recording.pvrc]   - messages of a recording, or a generated stream
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "alloc_counter.h"
+#include "json_serializer.h"
+#include "mqtt_recording.h"
+#include "solax_binary.h"
+#if HOST_HAVE_CJSON
+#include "cJSON.h"
+#endif
+
+namespace
+{
+    constexpr int Rounds = 50;
+
+    struct Result
+    {
+        double nsPerMessage;
+        double allocationsPerMessage;
+        SolaxParameters params;
+    };
+
+    template <typename Fn>
+    Result measure(const std::vector<std::string> &messages, Fn &&parse)
+    {
+        Result result{};
+        AllocCounter::Scope scope;
+        const auto start = std::chrono::steady_clock::now();
+        for (int round = 0; round < Rounds; ++round)
+        {
+            for (const auto &message : messages)
+                parse(result.params, std::string_view(message));
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        const double count = static_cast<double>(Rounds) * messages.size();
+        result.nsPerMessage = std::chrono::duration<double, std::nano>(elapsed).count() / count;
+        result.allocationsPerMessage = scope.allocations() / count;
+        return result;
+    }
+
+#if HOST_HAVE_CJSON
+    // the parser as it was - a DOM for every message
+    void cjsonUpdate(SolaxParameters &params, std::string_view message)
+    {
+        cJSON *json = cJSON_ParseWithLength(message.data(), message.size());
+        if (!json)
+            return;
+
+        cJSON *value = cJSON_GetObjectItem(json, "value");
+        cJSON *name = cJSON_GetObjectItem(json, "name");
+        if (cJSON_IsNumber(value) && cJSON_IsString(name))
+        {
+            const int index = SolaxFields::find(name->valuestring);
+            if (index != SolaxFields::NotFound)
+                SolaxFields::at(params, index) = static_cast<int32_t>(value->valuedouble);
+        }
+        cJSON_Delete(json);
+    }
+#endif
+
+    std::vector<std::string> generated()
+    {
+        std::vector<std::string> messages;
+        for (int frame = 0; frame < 100; ++frame)
+        {
+            for (int i = 0; i < SolaxFields::count; ++i)
+            {
+                const auto &field = SolaxFields::fields[i];
+                messages.push_back("{\"name\":\"" + std::string(field.name) + "\",\"value\":" + std::to_string(frame * 37 - i * 101) + "}");
+            }
+        }
+        return messages;
+    }
+
+    bool load(const char *path, std::vector<std::string> &messages)
+    {
+        MqttRecording recording;
+        if (!recording.open(path))
+            return false;
+
+        MqttRecording::Record record;
+        while (recording.next(record))
+        {
+            if (!SolaxBinary::isFrame(record.payload))
+                messages.emplace_back(record.payload);
+        }
+        return true;
+    }
+
+    void report(const char *name, const Result &result)
+    {
+        std::printf("%-26s %8.1f ns/msg %8.2f allocations/msg\n", name, result.nsPerMessage, result.allocationsPerMessage);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<std::string> messages;
+    if (argc > 1 ? !load(argv[1], messages) : (messages = generated(), false))
+        return 2;
+
+    // a message with anything after the value is malformed
+    SolaxParameters check;
+    if (JsonSerializer::updateParametersFromJson(check, R"({"name":"BattCap","value":12} trailing)") ||
+        !JsonSerializer::updateParametersFromJson(check, "{\"name\":\"BattCap\",\"value\":12}\r\n"))
+    {
+        std::printf("trailing data check failed\n");
+        return 1;
+    }
+
+    size_t bytes = 0;
+    for (const auto &message : messages)
+        bytes += message.size();
+    std::printf("%zu messages, %zu B average\n", messages.size(), messages.empty() ? 0 : bytes / messages.size());
+
+    auto reader = measure(messages, [](SolaxParameters &params, std::string_view message)
+                          { JsonSerializer::updateParametersFromJson(params, message); });
+    report("JsonReader (in place)", reader);
+
+#if HOST_HAVE_CJSON
+    cJSON_Hooks hooks{AllocCounter::countedMalloc, AllocCounter::countedFree};
+    cJSON_InitHooks(&hooks);
+    auto dom = measure(messages, cjsonUpdate);
+    report("cJSON DOM", dom);
+    if (std::memcmp(&reader.params, &dom.params, sizeof(SolaxParameters)) != 0)
+    {
+        std::printf("parsers disagree on the final values\n");
+        return 1;
+    }
+#else
+    std::printf("cJSON not found (IDF_PATH or CJSON_DIR), comparison skipped\n");
+#endif
+
+    return reader.allocationsPerMessage == 0 ? 0 : 1;
+}
@@ -0,0 +1,273 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2025 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   dashboard_bench.cpp
+/// @author Petr Vanek
+///
+/// Headless render of the Dashboard: LVGL draws into a memory frame buffer of
+/// the panel size, the demo day (demo_script.h) goes through the signal
+/// conditioner and the same Dashboard calls as DisplayTask::loop. Every update
+/// is rendered with lv_refr_now and reports the invalidated area and the
+/// render time, optionally the screen is written as PNG.
+///
+///   dashboard_bench [--png directory] [--every n]
+///
+/// --every n writes every n-th update (default 10), the first and the last
+/// update are always written.
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <png.h>
+#include "dashboard.h"
+#include "demo_script.h"
+#include "literals.h"
+#include "shoelace.h"
+#include "signal_conditioner.h"
+
+namespace
+{
+    constexpr int Width = 320;  // HW_LCD_H, portrait - LV_DISP_ROT_NONE
+    constexpr int Height = 480; // HW_LCD_V
+    constexpr uint32_t BufferLines = 100;      // CONFIG_PVVIEW_LCD_BUFFER_LINES default
+    constexpr uint32_t StepMs = 6 * 60 * 1000; // demo update = 6 minutes of the day
+    constexpr int StartHour = 5;
+
+    std::vector<lv_color_t> frameBuffer(Width * Height);
+
+    struct Refresh
+    {
+        uint32_t px{0};      // monitor_cb - rendered (invalidated) pixels
+        uint32_t flushes{0}; // flushed areas
+    } refresh;
+
+    void flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *colors)
+    {
+        const int width = lv_area_get_width(area);
+        for (int y = area->y1; y <= area->y2; ++y)
+        {
+            std::memcpy(&frameBuffer[y * Width + area->x1], colors, width * sizeof(lv_color_t));
+            colors += width;
+        }
+        ++refresh.flushes;
+        lv_disp_flush_ready(drv);
+    }
+
+    void monitor(lv_disp_drv_t *, uint32_t, uint32_t px)
+    {
+        refresh.px += px;
+    }
+
+    bool writePng(const std::string &path)
+    {
+        FILE *file = std::fopen(path.c_str(), "wb");
+        if (!file)
+        {
+            return false;
+        }
+
+        png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+        png_infop info = png ? png_create_info_struct(png) : nullptr;
+        if (!info || setjmp(png_jmpbuf(png)))
+        {
+            png_destroy_write_struct(&png, &info);
+            std::fclose(file);
+            return false;
+        }
+
+        png_init_io(png, file);
+        png_set_IHDR(png, info, Width, Height, 8, PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE,
+                     PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+        png_write_info(png, info);
+
+        std::vector<png_byte> row(Width * 3);
+        for (int y = 0; y < Height; ++y)
+        {
+            for (int x = 0; x < Width; ++x)
+            {
+                const lv_color32_t c{.full = lv_color_to32(frameBuffer[y * Width + x])};
+                row[x * 3] = c.ch.red;
+                row[x * 3 + 1] = c.ch.green;
+                row[x * 3 + 2] = c.ch.blue;
+            }
+            png_write_row(png, row.data());
+        }
+        png_write_end(png, nullptr);
+        png_destroy_write_struct(&png, &info);
+        return std::fclose(file) == 0;
+    }
+
+    /// @brief The dashboard part of DisplayTask::loop for one frame, the demo
+    ///        clock replaces the SNTP time; demo frames are synthetic, the energy
+    ///        is integrated here only to fill the chart
+    class Screen
+    {
+    public:
+        Screen() : _consumption("cons"), _photovoltaic("pv")
+        {
+            _dashboard.createScreen(nullptr);
+            _dashboard.createSettingsScreen();
+            _dashboard.clearAllDataSets();
+        }
+
+        void update(const SolaxFrame &frame, time_t now)
+        {
+            const auto &data = frame.params;
+            auto any = [&frame](auto... members)
+            { return (frame.changed & SolaxFields::maskOf(members...)) != 0; };
+
+            if (any(&SolaxParameters::Hdo))
+                _dashboard.hdoUpdate(data.Hdo);
+            if (any(&SolaxParameters::Powerdc1, &SolaxParameters::Powerdc2))
+                _dashboard.updateSolarPanels(data.Powerdc1, data.Powerdc2);
+            if (any(&SolaxParameters::BattCap, &SolaxParameters::Batpower_Charge1, &SolaxParameters::TemperatureBat))
+                _dashboard.updateBattery(data.BattCap, data.Batpower_Charge1, data.TemperatureBat);
+            auto inverterTotal = data.GridPower_R + data.GridPower_S + data.GridPower_T;
+            auto consumption = inverterTotal - data.FeedinPower;
+            auto photovoltaic = data.Powerdc1 + data.Powerdc2;
+
+            const bool grid = any(&SolaxParameters::GridPower_R, &SolaxParameters::GridPower_S, &SolaxParameters::GridPower_T);
+            const bool pv = any(&SolaxParameters::Powerdc1, &SolaxParameters::Powerdc2);
+            if (grid || any(&SolaxParameters::FeedinPower))
+                _dashboard.updateConsumption(consumption);
+            if (any(&SolaxParameters::FeedinPower, &SolaxParameters::GridStatus))
+                _dashboard.updateGrid(data.FeedinPower, (data.GridStatus == 0));
+            if (grid || any(&SolaxParameters::Temperature))
+                _dashboard.updateOverview(inverterTotal, data.Temperature);
+            if (grid || pv || any(&SolaxParameters::FeedinPower))
+                _dashboard.updateEnergyBar(photovoltaic - consumption);
+
+            struct tm tm;
+            localtime_r(&now, &tm);
+            char date[16];
+            char clock[8];
+            std::strftime(date, sizeof(date), "%d.%m.%Y", &tm);
+            std::strftime(clock, sizeof(clock), "%H:%M", &tm);
+            _dashboard.updateDateTime(date, clock);
+
+            _consumption.update(consumption, now);
+            _photovoltaic.update(photovoltaic, now);
+            _dashboard.updateTotal(static_cast<int>(_photovoltaic.getSum()), static_cast<int>(_consumption.getSum()));
+            _dashboard.updateDataSetHour(1, tm.tm_hour, _consumption.getConsumptionForHour(tm.tm_hour));
+            _dashboard.updateDataSetHour(0, tm.tm_hour, _photovoltaic.getConsumptionForHour(tm.tm_hour));
+        }
+
+    private:
+        Dashboard _dashboard;
+        Shoelace _consumption;
+        Shoelace _photovoltaic;
+    };
+}
+
+int main(int argc, char *argv[])
+{
+    const char *pngDir = nullptr;
+    uint32_t every = 10;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!std::strcmp(argv[i], "--png") && i + 1 < argc)
+            pngDir = argv[++i];
+        else if (!std::strcmp(argv[i], "--every") && i + 1 < argc)
+            every = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else
+        {
+            std::fprintf(stderr, "usage: %s [--png directory] [--every n]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    lv_init();
+
+    // partial draw buffer like the device default
+    static std::vector<lv_color_t> drawBuffer(Width * BufferLines);
+    static lv_disp_draw_buf_t drawBuf;
+    lv_disp_draw_buf_init(&drawBuf, drawBuffer.data(), nullptr, drawBuffer.size());
+
+    static lv_disp_drv_t drv;
+    lv_disp_drv_init(&drv);
+    drv.hor_res = Width;
+    drv.ver_res = Height;
+    drv.draw_buf = &drawBuf;
+    drv.flush_cb = flush;
+    drv.monitor_cb = monitor;
+    lv_disp_drv_register(&drv);
+
+    Screen screen;
+    lv_refr_now(nullptr);
+    std::printf("initial screen: %" PRIu32 " px in %" PRIu32 " flushes\n", refresh.px, refresh.flushes);
+
+    SignalConditioner conditioner;
+    conditioner.configure(literals::kv_def_signal);
+
+    struct tm start{};
+    start.tm_year = 2025 - 1900;
+    start.tm_mon = 5;
+    start.tm_mday = 21;
+    start.tm_hour = StartHour;
+    start.tm_isdst = -1;
+    const time_t day = mktime(&start);
+
+    DemoScript script;
+    SolaxParameters params;
+    uint32_t updates = 0;
+    uint64_t totalPx = 0;
+    uint32_t totalFlushes = 0;
+    std::chrono::nanoseconds totalRender{};
+    std::chrono::nanoseconds worstRender{};
+    uint32_t worstUpdate = 0;
+    uint32_t worstPx = 0;
+    int failed = 0;
+    while (script.next(params))
+    {
+        const auto frame = conditioner.process(params);
+
+        const time_t now = day + static_cast<time_t>(updates) * StepMs / 1000;
+        refresh = Refresh{};
+        screen.update(frame, now);
+        lv_tick_inc(StepMs);
+        const auto begin = std::chrono::steady_clock::now();
+        lv_refr_now(nullptr);
+        const auto render = std::chrono::steady_clock::now() - begin;
+
+        totalPx += refresh.px;
+        totalFlushes += refresh.flushes;
+        totalRender += render;
+        if (render > worstRender)
+        {
+            worstRender = render;
+            worstUpdate = updates;
+        }
+        if (refresh.px > worstPx)
+        {
+            worstPx = refresh.px;
+        }
+
+        const bool last = updates + 1 == DemoScript::length();
+        if (pngDir && (updates == 0 || last || (every && updates % every == 0)))
+        {
+            char name[32];
+            std::snprintf(name, sizeof(name), "/dashboard_%03" PRIu32 ".png", updates);
+            if (!writePng(pngDir + std::string(name)))
+            {
+                std::fprintf(stderr, "cannot write %s%s\n", pngDir, name);
+                ++failed;
+            }
+        }
+        ++updates;
+    }
+
+    const auto us = [](std::chrono::nanoseconds ns)
+    { return static_cast<double>(ns.count()) / 1000.0; };
+    std::printf("%" PRIu32 " updates, %.1f %% of the screen per update (worst %.1f %%), %.1f flushes per update\n",
+                updates, updates ? 100.0 * totalPx / updates / (Width * Height) : 0.0,
+                100.0 * worstPx / (Width * Height), updates ? static_cast<double>(totalFlushes) / updates : 0.0);
+    std::printf("render avg %.1f us, worst %.1f us (update %" PRIu32 ")\n",
+                updates ? us(totalRender) / updates : 0.0, us(worstRender), worstUpdate);
+    return failed ? 1 : 0;
+}
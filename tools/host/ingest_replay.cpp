@@ -0,0 +1,268 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2025 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   ingest_replay.cpp
+/// @author Petr Vanek
+///
+/// Replays a recording (mqtt_recording.h, NVS key "record" on the device) through
+/// the ingest path of IngestTask - ring, JsonSerializer / SolaxBinary, frame
+/// assembly, signal conditioning - and integrates the energy with Shoelace the way
+/// DisplayTask does, on the timestamps of the recording.
+///
+///   ingest_replay [-x speed] [--expect pvWh:consumptionWh] [--signal config] recording.pvrc
+///   ingest_replay --synthesize output.pvrc
+///
+/// speed is N x real time, 0 - as fast as possible. --expect fails when a total
+/// differs by more than 0.5 %. --signal replaces the signal conditioning
+/// (KeyVal "signal"), the energy totals must not depend on it. --synthesize writes the demo day (demo_script.h)
+/// as gateway name/value messages.
+
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "alloc_counter.h"
+#include "demo_script.h"
+#include "inverter_aggregator.h"
+#include "json_serializer.h"
+#include "literals.h"
+#include "mqtt_recording.h"
+#include "shoelace.h"
+#include "signal_conditioner.h"
+#include "solax_binary.h"
+#include "spsc_ring.h"
+
+namespace
+{
+    constexpr size_t RingSize = 4096;        // IngestTask::RingSize
+    constexpr size_t MaxBatch = 16;          // IngestTask::MaxBatch
+    constexpr uint32_t StaleMs = 30 * 1000;  // IngestTask::DefaultStaleSec
+    constexpr uint32_t SynthesizedStepMs = 2000;
+
+    struct Message
+    {
+        uint32_t timeMs;
+        std::string topic;
+        std::string payload;
+    };
+
+    /// @brief IngestTask::loop / onMessage and the energy part of DisplayTask::loop,
+    ///        the recording time is the tick count (1 tick = 1 ms)
+    class Pipeline
+    {
+    public:
+        explicit Pipeline(const char *signal) : _consumption("cons"), _photovoltaic("pv")
+        {
+            _conditioner.configure(signal);
+        }
+
+        void feed(const Message &message)
+        {
+            ++_messages;
+            _ring.push(message.topic, message.payload);
+
+            const TickType_t now = message.timeMs;
+            bool changed = false;
+            SpscRing<RingSize>::Record record;
+            for (size_t batch = 0; batch < MaxBatch && _ring.peek(record); ++batch)
+            {
+                changed |= onMessage(record.topic, record.payload, now);
+                _ring.pop();
+            }
+
+            for (int i = 0; i < _inverters.count(); ++i)
+            {
+                if (_inverters.inverter(i).frame.expired(now))
+                {
+                    commitFrame(i);
+                    changed = true;
+                }
+            }
+
+            if (changed)
+                publishSite(now);
+        }
+
+        uint32_t messages() const { return _messages; }
+        uint32_t frames() const { return _frames; }
+        uint32_t drops() const { return _ring.drops(); }
+        uint32_t timeouts() const { return _timeouts; }
+        float photovoltaicWh() { return _photovoltaic.getSum(); }
+        float consumptionWh() { return _consumption.getSum(); }
+
+    private:
+        bool onMessage(std::string_view topic, std::string_view payload, TickType_t now)
+        {
+            const int index = _inverters.find(topic);
+            if (index < 0)
+                return false;
+
+            auto &inverter = _inverters.inverter(index);
+            const auto updated = SolaxBinary::isFrame(payload) ? SolaxBinary::decode(inverter.data, payload)
+                                                               : JsonSerializer::updateParametersFromJson(inverter.data, payload);
+            _arrival.stamp(updated, now);
+            if (inverter.frame.add(updated, now))
+            {
+                commitFrame(index);
+                return true;
+            }
+            return false;
+        }
+
+        void commitFrame(int index)
+        {
+            auto &inverter = _inverters.inverter(index);
+            if (!inverter.frame.complete())
+                ++_timeouts;
+            inverter.frame.reset();
+            _inverters.commit(index);
+            ++_frames;
+        }
+
+        void publishSite(TickType_t now)
+        {
+            const SolaxFrame frame = _conditioner.process(_inverters.site());
+            const auto stale = _arrival.stale(now, StaleMs);
+            auto isStale = [stale](auto... members)
+            { return (stale & SolaxFields::maskOf(members...)) != 0; };
+
+            const auto &data = frame.raw; // DisplayTask integrates the values as received
+            const int32_t consumption = data.GridPower_R + data.GridPower_S + data.GridPower_T - data.FeedinPower;
+            const int32_t photovoltaic = data.Powerdc1 + data.Powerdc2;
+            const time_t seconds = now / 1000;
+
+            if (isStale(&SolaxParameters::GridPower_R, &SolaxParameters::GridPower_S, &SolaxParameters::GridPower_T, &SolaxParameters::FeedinPower))
+                _consumption.pause();
+            else
+                _consumption.update(consumption, seconds);
+            if (isStale(&SolaxParameters::Powerdc1, &SolaxParameters::Powerdc2))
+                _photovoltaic.pause();
+            else
+                _photovoltaic.update(photovoltaic, seconds);
+        }
+
+        SpscRing<RingSize> _ring;
+        InverterAggregator _inverters;
+        SignalConditioner _conditioner;
+        FieldTimes _arrival;
+        Shoelace _consumption;
+        Shoelace _photovoltaic;
+        uint32_t _messages{0};
+        uint32_t _frames{0};
+        uint32_t _timeouts{0};
+    };
+
+    bool load(const char *path, std::vector<Message> &messages)
+    {
+        MqttRecording recording;
+        if (!recording.open(path))
+            return false;
+
+        MqttRecording::Record record;
+        while (recording.next(record))
+            messages.push_back({record.timeMs, std::string(record.topic), std::string(record.payload)});
+        return true;
+    }
+
+    int synthesize(const char *path)
+    {
+        MqttRecording recording;
+        if (!recording.create(path))
+            return 2;
+
+        DemoScript script;
+        SolaxParameters params;
+        uint32_t timeMs = 0;
+        while (script.next(params))
+        {
+            for (int i = 0; i < SolaxFields::count; ++i)
+            {
+                const std::string payload = "{\"name\":\"" + std::string(SolaxFields::fields[i].name) +
+                                            "\",\"value\":" + std::to_string(SolaxFields::at(params, i)) + "}";
+                recording.append(timeMs + i * 20, "solax/data", payload);
+            }
+            timeMs += SynthesizedStepMs;
+        }
+
+        std::printf("%" PRIu32 " messages, %" PRIu32 " s -> %s\n", recording.count(), timeMs / 1000, path);
+        return 0;
+    }
+
+    bool near(double value, double expected)
+    {
+        return std::fabs(value - expected) <= std::fabs(expected) * 0.005 + 0.05;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t speed = 1;
+    const char *expect = nullptr;
+    const char *signal = literals::kv_def_signal;
+    const char *path = nullptr;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!std::strcmp(argv[i], "--synthesize") && i + 1 < argc)
+            return synthesize(argv[++i]);
+        if (!std::strcmp(argv[i], "-x") && i + 1 < argc)
+            speed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (!std::strcmp(argv[i], "--expect") && i + 1 < argc)
+            expect = argv[++i];
+        else if (!std::strcmp(argv[i], "--signal") && i + 1 < argc)
+            signal = argv[++i];
+        else
+            path = argv[i];
+    }
+
+    std::vector<Message> messages;
+    if (!path || !load(path, messages))
+    {
+        std::fprintf(stderr, "usage: %s [-x speed] [--expect pvWh:consumptionWh] [--signal config] recording.pvrc\n"
+                             "       %s --synthesize output.pvrc\n", argv[0], argv[0]);
+        return 2;
+    }
+
+    Pipeline pipeline(signal);
+    std::chrono::steady_clock::duration busy{};
+    uint64_t allocations = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto &message : messages)
+    {
+        if (speed)
+            std::this_thread::sleep_until(start + std::chrono::milliseconds(message.timeMs / speed));
+
+        const auto begin = std::chrono::steady_clock::now();
+        AllocCounter::Scope scope;
+        pipeline.feed(message);
+        allocations += scope.allocations();
+        busy += std::chrono::steady_clock::now() - begin;
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    const double seconds = std::chrono::duration<double>(elapsed).count();
+    const double count = pipeline.messages() ? pipeline.messages() : 1;
+    const uint32_t recorded = messages.empty() ? 0 : messages.back().timeMs / 1000;
+    std::printf("%" PRIu32 " messages, %" PRIu32 " frames (%" PRIu32 " timed out), %" PRIu32 " ring drops, recorded %" PRIu32 " s\n",
+                pipeline.messages(), pipeline.frames(), pipeline.timeouts(), pipeline.drops(), recorded);
+    std::printf("%.0f msg/s at %" PRIu32 "x, %.1f ns/msg processing, %.2f allocations/msg\n",
+                pipeline.messages() / seconds, speed, std::chrono::duration<double, std::nano>(busy).count() / count, allocations / count);
+    std::printf("PV %.1f Wh, consumption %.1f Wh\n", pipeline.photovoltaicWh(), pipeline.consumptionWh());
+
+    if (expect)
+    {
+        double pvWh = 0, consumptionWh = 0;
+        if (std::sscanf(expect, "%lf:%lf", &pvWh, &consumptionWh) != 2 ||
+            !near(pipeline.photovoltaicWh(), pvWh) || !near(pipeline.consumptionWh(), consumptionWh))
+        {
+            std::printf("FAIL: expected PV %.1f Wh, consumption %.1f Wh\n", pvWh, consumptionWh);
+            return 1;
+        }
+    }
+    return allocations ? 1 : 0;
+}
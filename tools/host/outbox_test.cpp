@@ -0,0 +1,246 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2025 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   outbox_test.cpp
+/// @author Petr Vanek
+///
+/// Store-and-forward of derived metrics against a broker stand-in: the broker
+/// is killed, records go to the outbox file, the device "resets" (the outbox is
+/// reopened from the file), the broker dies again in the middle of the drain -
+/// once before it read the records in flight, once after it read them but
+/// before the PUBACKs arrived. The broker acknowledges QoS 1 asynchronously.
+/// Every record has to arrive in order, again only when its PUBACK was lost,
+/// with at most DrainPerCycle records in flight.
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+#include "metrics_publisher.h"
+#include "mqtt.h"
+#include "outbox.h"
+
+namespace
+{
+    constexpr uint32_t DrainPerCycle = 2; // MqttTask::MaxDrainPerCycle
+    constexpr const char *Topic = "pvview/metrics";
+    constexpr time_t FirstTimestamp = 1718000000;
+
+    int failures = 0;
+
+    void check(bool condition, const char *what)
+    {
+        if (!condition)
+        {
+            std::printf("FAIL: %s\n", what);
+            ++failures;
+        }
+    }
+
+    class Broker
+    {
+    public:
+        void attach(esp_mqtt_client_handle_t client)
+        {
+            client->publish = [this](std::string_view topic, std::string_view data, int qos, int msgId)
+            {
+                if (!_up)
+                    return -1;
+                if (topic != Topic)
+                    return 0;
+                if (qos)
+                    _unread.push_back({msgId, std::string(data)});
+                else
+                    received.emplace_back(data);
+                return 0;
+            };
+        }
+
+        /// @brief Reads the QoS 1 messages, ack false - the PUBACKs are lost on the way back
+        void process(bool ack = true)
+        {
+            for (auto &message : _unread)
+            {
+                received.push_back(message.data);
+                if (ack)
+                {
+                    esp_mqtt_event_t event;
+                    event.event_id = MQTT_EVENT_PUBLISHED;
+                    event.msg_id = message.id;
+                    hostMqttDeliver(event);
+                }
+            }
+            _unread.clear();
+        }
+
+        void start()
+        {
+            _up = true;
+            esp_mqtt_event_t event;
+            event.event_id = MQTT_EVENT_CONNECTED;
+            event.session_present = 1;
+            hostMqttDeliver(event);
+        }
+
+        // messages still in the socket are lost with the connection
+        void kill()
+        {
+            _up = false;
+            _unread.clear();
+            esp_mqtt_event_t event;
+            event.event_id = MQTT_EVENT_DISCONNECTED;
+            hostMqttDeliver(event);
+        }
+
+        std::vector<std::string> received;
+
+    private:
+        struct Message
+        {
+            int id;
+            std::string data;
+        };
+        std::vector<Message> _unread;
+        bool _up{false};
+    };
+
+    // publishMetrics() of MqttTask: live when connected, else into the outbox
+    void produce(Mqtt &mqtt, Outbox &outbox, MetricsPublisher &publisher, int sequence)
+    {
+        DerivedMetrics metrics;
+        metrics.consumption = sequence;
+        char batch[MetricsPublisher::MaxBatch];
+        publisher.reset();
+        const size_t length = publisher.build(metrics, FirstTimestamp + sequence, batch, sizeof(batch));
+        if (!mqtt.publish(Topic, std::string_view(batch, length), 0))
+            outbox.push(std::string_view(batch, length));
+    }
+
+    int sequenceOf(const std::string &record)
+    {
+        long long timestamp = 0;
+        return std::sscanf(record.c_str(), "{\"ts\":%lld", &timestamp) == 1 ? static_cast<int>(timestamp - FirstTimestamp) : -1;
+    }
+
+    /// @return records received again, -1 when one is missing or out of order
+    int duplicates(const std::vector<std::string> &received, int count)
+    {
+        int next = 0;
+        int again = 0;
+        for (const auto &record : received)
+        {
+            const int sequence = sequenceOf(record);
+            if (sequence == next)
+                ++next;
+            else if (sequence >= 0 && sequence < next)
+                ++again;
+            else
+                return -1;
+        }
+        return next == count ? again : -1;
+    }
+}
+
+int main()
+{
+    const std::string path = (std::getenv("TMPDIR") ? std::string(std::getenv("TMPDIR")) : std::string("/tmp")) + "/pvview_outbox_test.bin";
+    std::remove(path.c_str());
+
+    Broker broker;
+    Mqtt mqtt;
+    mqtt.init("mqtt://broker");
+    broker.attach(hostMqttClient);
+    MetricsPublisher publisher;
+
+    auto outbox = std::make_unique<Outbox>();
+    mqtt.registerPublishedCallback([&outbox](int msgId)
+                                   { outbox->acknowledge(msgId); });
+    check(outbox->open(path), "outbox file created");
+    check(outbox->persistent(), "outbox is file backed");
+
+    // live, then the broker goes away
+    broker.start();
+    int sequence = 0;
+    for (; sequence < 5; ++sequence)
+        produce(mqtt, *outbox, publisher, sequence);
+    check(outbox->empty(), "nothing stored while online");
+
+    broker.kill();
+    for (; sequence < 45; ++sequence)
+        produce(mqtt, *outbox, publisher, sequence);
+    check(outbox->size() == 40, "offline records stored");
+
+    // reset - the records survive in the file
+    outbox = std::make_unique<Outbox>();
+    outbox->open(path);
+    check(outbox->size() == 40, "records kept across a reset");
+
+    // drain at a limited pace, the broker dies twice more half way
+    auto drain = [&]()
+    {
+        return outbox->drain(DrainPerCycle, [&](std::string_view record)
+                             { return mqtt.publishId(Topic, record, 1); });
+    };
+    broker.start();
+    int cycles = 0;
+    uint32_t maxInFlight = 0;
+    while (!outbox->empty() && cycles < 1000)
+    {
+        drain();
+        maxInFlight = std::max(maxInFlight, outbox->inFlight());
+        if (cycles == 10)
+        {
+            // link lost before the broker read the records
+            const uint32_t pending = outbox->size();
+            broker.kill();
+            check(outbox->inFlight() == DrainPerCycle && outbox->size() == pending, "records kept until their PUBACK");
+            outbox->resend(); // MqttTask: no PUBACK within AckTimeout
+            check(drain() == 0 && outbox->inFlight() == 0, "nothing drained while the broker is down");
+            broker.start();
+        }
+        else if (cycles == 14)
+        {
+            // the broker read the records, the PUBACKs are lost
+            broker.process(false);
+            broker.kill();
+            outbox->resend();
+            broker.start();
+        }
+        else
+        {
+            broker.process();
+        }
+        ++cycles;
+    }
+
+    check(outbox->empty(), "outbox drained");
+    check(duplicates(broker.received, 45) == DrainPerCycle, "every record received in order, again only after a lost PUBACK");
+    check(maxInFlight <= DrainPerCycle, "drain stays within its window");
+    check(cycles == 22, "40 records need 20 drain cycles, two more for the lost ones");
+    check(outbox->dropped() == 0, "nothing dropped");
+
+    // full file - the oldest records are overwritten and counted
+    broker.kill();
+    broker.received.clear();
+    const int overflow = static_cast<int>(Outbox::FileSlots) + 10;
+    for (int i = 0; i < overflow; ++i)
+        produce(mqtt, *outbox, publisher, i);
+    check(outbox->size() == Outbox::FileSlots, "outbox bounded by its slots");
+    check(outbox->dropped() == 10, "overwritten records counted");
+
+    // no card - RAM fallback
+    Outbox ram;
+    check(!ram.open("") && ram.isOpen() && !ram.persistent(), "RAM outbox without a path");
+    for (int i = 0; i < 20; ++i)
+        produce(mqtt, ram, publisher, i);
+    check(ram.size() == Outbox::RamSlots, "RAM outbox bounded");
+
+    outbox.reset();
+    std::remove(path.c_str());
+    std::printf("%s: %d drain cycles, at most %" PRIu32 " records in flight\n", failures ? "FAILED" : "OK", cycles, maxInFlight);
+    return failures ? 1 : 0;
+}
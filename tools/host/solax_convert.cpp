@@ -0,0 +1,154 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2025 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   solax_convert.cpp
+/// @author Petr Vanek
+///
+/// Converts the JSON payloads of a recorded MQTT stream into SolaxBinary frames
+/// and compares size and decode time of both forms.
+///
+///   solax_convert input output.pvrc
+///
+/// input is a recording (mqtt_recording.h) or a text file with one JSON message
+/// per line (topic "solax/data", one second apart). Every JSON message becomes
+/// a frame with the fields it carried, topics and times are kept.
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "json_serializer.h"
+#include "mqtt_recording.h"
+#include "solax_binary.h"
+
+namespace
+{
+    constexpr int Rounds = 50;
+
+    struct Message
+    {
+        uint32_t timeMs;
+        std::string topic;
+        std::string payload;
+    };
+
+    bool isRecording(const char *path)
+    {
+        char magic[4] = {};
+        std::ifstream file(path, std::ios::binary);
+        return file.read(magic, sizeof(magic)) && std::memcmp(magic, "PVRC", sizeof(magic)) == 0;
+    }
+
+    bool load(const char *path, std::vector<Message> &messages)
+    {
+        if (isRecording(path))
+        {
+            MqttRecording recording;
+            if (!recording.open(path))
+                return false;
+
+            MqttRecording::Record record;
+            while (recording.next(record))
+                messages.push_back({record.timeMs, std::string(record.topic), std::string(record.payload)});
+            return true;
+        }
+
+        std::ifstream file(path);
+        if (!file)
+            return false;
+
+        std::string line;
+        while (std::getline(file, line))
+        {
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            if (!line.empty())
+                messages.push_back({static_cast<uint32_t>(messages.size() * 1000), "solax/data", line});
+        }
+        return true;
+    }
+
+    template <typename Fn>
+    double nsPerMessage(const std::vector<std::string> &payloads, Fn &&decode)
+    {
+        SolaxParameters params;
+        const auto start = std::chrono::steady_clock::now();
+        for (int round = 0; round < Rounds; ++round)
+        {
+            for (const auto &payload : payloads)
+                decode(params, std::string_view(payload));
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double, std::nano>(elapsed).count() / (static_cast<double>(Rounds) * payloads.size());
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 3)
+    {
+        std::fprintf(stderr, "usage: %s input output.pvrc\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<Message> messages;
+    if (!load(argv[1], messages))
+    {
+        std::fprintf(stderr, "cannot read %s\n", argv[1]);
+        return 2;
+    }
+
+    MqttRecording output;
+    if (!output.create(argv[2]))
+        return 2;
+
+    std::vector<std::string> json;
+    std::vector<std::string> binary;
+    size_t jsonBytes = 0, binaryBytes = 0, skipped = 0;
+    for (const auto &message : messages)
+    {
+        if (SolaxBinary::isFrame(message.payload))
+        {
+            // already binary, copied as is
+            output.append(message.timeMs, message.topic, message.payload);
+            continue;
+        }
+
+        SolaxParameters params;
+        const auto mask = JsonSerializer::updateParametersFromJson(params, message.payload);
+        uint8_t frame[SolaxBinary::MaxFrameSize];
+        const size_t size = mask ? SolaxBinary::encode(params, mask, frame, sizeof(frame)) : 0;
+        if (!size)
+        {
+            ++skipped;
+            continue;
+        }
+
+        const std::string_view payload(reinterpret_cast<const char *>(frame), size);
+        output.append(message.timeMs, message.topic, payload);
+        json.push_back(message.payload);
+        binary.emplace_back(payload);
+        jsonBytes += message.payload.size();
+        binaryBytes += size;
+    }
+    output.close();
+
+    if (json.empty())
+    {
+        std::fprintf(stderr, "no JSON messages converted\n");
+        return 1;
+    }
+
+    const double jsonNs = nsPerMessage(json, [](SolaxParameters &params, std::string_view payload)
+                                       { JsonSerializer::updateParametersFromJson(params, payload); });
+    const double binaryNs = nsPerMessage(binary, [](SolaxParameters &params, std::string_view payload)
+                                         { SolaxBinary::decode(params, payload); });
+
+    std::printf("%zu messages converted, %zu skipped -> %s\n", json.size(), skipped, argv[2]);
+    std::printf("JSON   %8zu B %7.1f B/msg %7.1f ns/msg\n", jsonBytes, static_cast<double>(jsonBytes) / json.size(), jsonNs);
+    std::printf("binary %8zu B %7.1f B/msg %7.1f ns/msg\n", binaryBytes, static_cast<double>(binaryBytes) / json.size(), binaryNs);
+    return 0;
+}
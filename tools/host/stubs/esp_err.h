@@ -0,0 +1,13 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2025 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   esp_err.h  host stand-in
+/// @author Petr Vanek
+
+#pragma once
+
+using esp_err_t = int;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
@@ -0,0 +1,28 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2025 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   esp_log.h  host stand-in, prints to stderr
+/// @author Petr Vanek
+
+#pragma once
+
+#include <cstdio>
+
+// 0 - none, 1 - error, 2 - warning, 3 - info, 4 - debug
+#ifndef HOST_LOG_LEVEL
+#define HOST_LOG_LEVEL 2
+#endif
+
+#define HOST_LOG(level, letter, tag, format, ...)                                      \
+    do                                                                                 \
+    {                                                                                  \
+        if (HOST_LOG_LEVEL >= level)                                                   \
+            std::fprintf(stderr, letter " (%s) " format "\n", tag __VA_OPT__(, ) __VA_ARGS__); \
+    } while (0)
+
+#define ESP_LOGE(tag, format, ...) HOST_LOG(1, "E", tag, format __VA_OPT__(, ) __VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) HOST_LOG(2, "W", tag, format __VA_OPT__(, ) __VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) HOST_LOG(3, "I", tag, format __VA_OPT__(, ) __VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) HOST_LOG(4, "D", tag, format __VA_OPT__(, ) __VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) HOST_LOG(5, "V", tag, format __VA_OPT__(, ) __VA_ARGS__)
@@ -0,0 +1,10 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2025 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   esp_sntp.h  host stand-in, utils.h only needs time()
+/// @author Petr Vanek
+
+#pragma once
+
+#include <time.h>
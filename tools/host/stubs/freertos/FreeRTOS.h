@@ -0,0 +1,21 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2025 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   FreeRTOS.h  host stand-in, 1 tick = 1 ms
+/// @author Petr Vanek
+
+#pragma once
+
+#include <cstdint>
+
+using TickType_t = uint32_t;
+using BaseType_t = int;
+using UBaseType_t = unsigned;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define portMAX_DELAY 0xFFFFFFFFu
+#define configTICK_RATE_HZ 1000
+// same 32 bit arithmetic as FreeRTOS, including its overflow
+#define pdMS_TO_TICKS(ms) (static_cast<TickType_t>(static_cast<TickType_t>(ms) * static_cast<TickType_t>(configTICK_RATE_HZ) / 1000u))
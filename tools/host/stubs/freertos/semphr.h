@@ -0,0 +1,28 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2025 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   semphr.h  host stand-in, a mutex is a std::mutex
+/// @author Petr Vanek
+
+#pragma once
+
+#include <mutex>
+#include "freertos/FreeRTOS.h"
+
+using SemaphoreHandle_t = std::mutex *;
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() { return new std::mutex; }
+inline void vSemaphoreDelete(SemaphoreHandle_t mutex) { delete mutex; }
+
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t mutex, TickType_t)
+{
+    mutex->lock();
+    return pdTRUE;
+}
+
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t mutex)
+{
+    mutex->unlock();
+    return pdTRUE;
+}
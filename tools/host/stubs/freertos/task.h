@@ -0,0 +1,23 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2025 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   task.h  host stand-in
+/// @author Petr Vanek
+
+#pragma once
+
+#include <chrono>
+#include <thread>
+#include "freertos/FreeRTOS.h"
+
+inline TickType_t xTaskGetTickCount()
+{
+    using namespace std::chrono;
+    return static_cast<TickType_t>(duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+inline void vTaskDelay(TickType_t ticks)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
@@ -0,0 +1,141 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2025 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   mqtt_client.h  host stand-in of esp-mqtt
+/// @author Petr Vanek
+///
+/// The client does not talk to a broker. A test plays the broker: it delivers
+/// events with hostMqttDeliver() and receives publishes through the publish hook.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include "esp_err.h"
+
+using esp_event_base_t = const char *;
+using esp_event_handler_t = void (*)(void *handler_args, esp_event_base_t base, int32_t event_id, void *event_data);
+
+enum esp_mqtt_event_id_t
+{
+    MQTT_EVENT_ANY = -1,
+    MQTT_EVENT_ERROR = 0,
+    MQTT_EVENT_CONNECTED,
+    MQTT_EVENT_DISCONNECTED,
+    MQTT_EVENT_SUBSCRIBED,
+    MQTT_EVENT_UNSUBSCRIBED,
+    MQTT_EVENT_PUBLISHED,
+    MQTT_EVENT_DATA,
+};
+
+struct esp_mqtt_event_t
+{
+    esp_mqtt_event_id_t event_id{MQTT_EVENT_ANY};
+    char *data{nullptr};
+    int data_len{0};
+    int total_data_len{0};
+    int current_data_offset{0};
+    char *topic{nullptr};
+    int topic_len{0};
+    int msg_id{0};
+    int session_present{0};
+};
+using esp_mqtt_event_handle_t = esp_mqtt_event_t *;
+
+struct esp_mqtt_client_config_t
+{
+    struct
+    {
+        struct
+        {
+            const char *uri{nullptr};
+        } address;
+    } broker;
+    struct
+    {
+        const char *username{nullptr};
+        const char *client_id{nullptr};
+        struct
+        {
+            const char *password{nullptr};
+        } authentication;
+    } credentials;
+    struct
+    {
+        bool disable_clean_session{false};
+    } session;
+    struct
+    {
+        int reconnect_timeout_ms{0};
+    } network;
+};
+
+/// @brief Broker side of the stand-in, return -1 to refuse (broker down). The PUBACK
+///        of a QoS 1 message is not automatic, the broker delivers MQTT_EVENT_PUBLISHED
+///        with msgId when it likes (or never).
+using HostMqttPublishHook = std::function<int(std::string_view topic, std::string_view data, int qos, int msgId)>;
+
+struct esp_mqtt_client
+{
+    esp_event_handler_t handler{nullptr};
+    void *handlerArgs{nullptr};
+    HostMqttPublishHook publish;
+    int subscribes{0};
+    int nextId{1};
+};
+using esp_mqtt_client_handle_t = esp_mqtt_client *;
+
+// the last client created, the code under test keeps its handle private
+inline esp_mqtt_client_handle_t hostMqttClient{nullptr};
+
+inline esp_mqtt_client_handle_t esp_mqtt_client_init(const esp_mqtt_client_config_t *)
+{
+    hostMqttClient = new esp_mqtt_client;
+    return hostMqttClient;
+}
+
+inline esp_err_t esp_mqtt_client_start(esp_mqtt_client_handle_t) { return ESP_OK; }
+inline esp_err_t esp_mqtt_client_stop(esp_mqtt_client_handle_t) { return ESP_OK; }
+inline esp_err_t esp_mqtt_client_reconnect(esp_mqtt_client_handle_t) { return ESP_OK; }
+inline esp_err_t esp_mqtt_client_destroy(esp_mqtt_client_handle_t client)
+{
+    if (client == hostMqttClient)
+        hostMqttClient = nullptr;
+    delete client;
+    return ESP_OK;
+}
+
+inline esp_err_t esp_mqtt_client_register_event(esp_mqtt_client_handle_t client, esp_mqtt_event_id_t, esp_event_handler_t handler, void *args)
+{
+    client->handler = handler;
+    client->handlerArgs = args;
+    return ESP_OK;
+}
+
+inline int esp_mqtt_client_subscribe(esp_mqtt_client_handle_t client, const char *, int)
+{
+    ++client->subscribes;
+    return client->nextId++;
+}
+
+inline int esp_mqtt_client_unsubscribe(esp_mqtt_client_handle_t client, const char *)
+{
+    return client->nextId++;
+}
+
+inline int esp_mqtt_client_publish(esp_mqtt_client_handle_t client, const char *topic, const char *data, int len, int qos, int)
+{
+    const int msgId = client->nextId++;
+    if (client->publish && client->publish(topic, std::string_view(data, len), qos, msgId) < 0)
+        return -1;
+    return qos ? msgId : 0;
+}
+
+/// @brief Runs the registered event handler as the esp-mqtt task would
+inline void hostMqttDeliver(esp_mqtt_event_t &event, esp_mqtt_client_handle_t client = hostMqttClient)
+{
+    if (client && client->handler)
+        client->handler(client->handlerArgs, "MQTT_EVENTS", event.event_id, &event);
+}
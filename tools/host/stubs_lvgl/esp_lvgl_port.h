@@ -0,0 +1,31 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2025 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   esp_lvgl_port.h  host stand-in of esp_lvgl_port
+/// @author Petr Vanek
+///
+/// LVGL runs on the bench thread only, the lock is a no-op and the panel
+/// handles are opaque.
+
+#pragma once
+
+#include <cstdint>
+#include "esp_err.h"
+#include "lvgl.h"
+
+typedef struct esp_lcd_panel_io_t *esp_lcd_panel_io_handle_t;
+typedef struct esp_lcd_touch_s *esp_lcd_touch_handle_t;
+typedef struct
+{
+} esp_lcd_panel_io_event_data_t;
+
+inline bool lvgl_port_lock(uint32_t timeout_ms)
+{
+    (void)timeout_ms;
+    return true;
+}
+
+inline void lvgl_port_unlock()
+{
+}
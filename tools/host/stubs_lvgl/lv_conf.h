@@ -0,0 +1,33 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2025 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   lv_conf.h
+/// @author Petr Vanek
+///
+/// LVGL 8 configuration of the host dashboard bench - the values of
+/// sdkconfig.defaults, everything else is the LVGL default.
+
+#ifndef LV_CONF_H
+#define LV_CONF_H
+
+#define LV_COLOR_DEPTH 16
+#define LV_COLOR_16_SWAP 0 // swapped for the SPI panel only, the bench writes PNG
+
+#define LV_MEM_CUSTOM 1
+#define LV_MEMCPY_MEMSET_STD 1
+
+#define LV_TICK_CUSTOM 0 // the bench advances the tick itself
+#define LV_DISP_DEF_REFR_PERIOD 30
+
+#define LV_USE_LOG 0
+#define LV_USE_PERF_MONITOR 0
+#define LV_USE_MEM_MONITOR 0
+
+#define LV_FONT_MONTSERRAT_8 1
+#define LV_FONT_MONTSERRAT_12 1
+#define LV_FONT_MONTSERRAT_14 1
+#define LV_FONT_MONTSERRAT_16 1
+#define LV_FONT_MONTSERRAT_20 1
+
+#endif // LV_CONF_H
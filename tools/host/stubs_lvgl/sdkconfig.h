@@ -0,0 +1,10 @@
+//
+// vim: ts=4 et
+// Copyright (c) 2025 Petr Vanek, petr@fotoventus.cz
+//
+/// @file   sdkconfig.h  host stand-in, the Kconfig values the dashboard reads
+/// @author Petr Vanek
+
+#pragma once
+
+#define CONFIG_PVVIEW_DISPLAY_STATS 0